@@ -0,0 +1,59 @@
+/**
+    @author Eduard Igushev visit <www.igushev.com> e-mail <eduard@igushev.com>
+    @brief Allocator propagation helpers
+
+    The containers swap and move their allocators only if the allocator asks for it,
+    as the standard containers do. An allocator which does not propagate,
+    like std::pmr::polymorphic_allocator, may have no assignment at all,
+    so the choice is made at compile time.
+
+    Warranty and license
+    The implementation is provided “as it is” with no warranty.
+    Any private and commercial usage is allowed.
+    Keeping the original name and link to the source is required.
+    Any feedback is welcomed :-)
+*/
+
+#ifndef _ALLOC_HELPER_H
+#define _ALLOC_HELPER_H
+
+#include <memory>
+#include <utility>
+#include <type_traits>
+
+template <class Alloc>
+void alloc_swap(Alloc& a1, Alloc& a2, std::true_type)
+{
+    using std::swap;
+    swap(a1, a2);
+}
+
+template <class Alloc>
+void alloc_swap(Alloc&, Alloc&, std::false_type)
+{
+}
+
+template <class Alloc>
+void alloc_swap(Alloc& a1, Alloc& a2)
+{
+    alloc_swap(a1, a2, typename std::allocator_traits<Alloc>::propagate_on_container_swap());
+}
+
+template <class Alloc>
+void alloc_move_assign(Alloc& to, Alloc& from, std::true_type)
+{
+    to = std::move(from);
+}
+
+template <class Alloc>
+void alloc_move_assign(Alloc&, Alloc&, std::false_type)
+{
+}
+
+template <class Alloc>
+void alloc_move_assign(Alloc& to, Alloc& from)
+{
+    alloc_move_assign(to, from, typename std::allocator_traits<Alloc>::propagate_on_container_move_assignment());
+}
+
+#endif
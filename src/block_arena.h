@@ -0,0 +1,213 @@
+/**
+    @author Eduard Igushev visit <www.igushev.com> e-mail <eduard@igushev.com>
+    @brief Slab arena for block storage
+
+    The BlockArena class hands out chunks of the same size which are carved
+    from a few big contiguous slabs. Chunks are given away in address order,
+    so blocks created one after another are placed next to each other in memory.
+    Released chunks are kept in a free list and reused before the slab is advanced.
+    Every new slab is as big as all previous ones together,
+    so the number of slabs grows only logarithmically.
+
+    The arena gives raw storage only, it never constructs or destroys objects.
+    The slabs may be mapped in huge pages instead of being taken from the allocator,
+    then every slab is rounded up to whole huge pages and the rest is used for more chunks.
+
+    Warranty and license
+    The implementation is provided “as it is” with no warranty.
+    Any private and commercial usage is allowed.
+    Keeping the original name and link to the source is required.
+    Any feedback is welcomed :-)
+*/
+
+#ifndef _BlockArena_h
+#define _BlockArena_h
+
+#include <memory>
+#include <vector>
+#include <utility>
+#include "alloc_helper.h"
+#include "huge_pages.h"
+
+template <class T, class Alloc = std::allocator<T> >
+class BlockArena {
+
+    typedef std::allocator_traits<Alloc> AllocTraits;
+    typedef T* TPtr;
+    typedef std::pair<TPtr, typename AllocTraits::size_type> Slab;
+    typedef std::vector<Slab, typename AllocTraits::template rebind_alloc<Slab> > SlabVec;
+    typedef std::vector<TPtr, typename AllocTraits::template rebind_alloc<TPtr> > TPtrVec;
+
+public:
+
+    typedef Alloc allocator_type;
+    typedef typename AllocTraits::size_type size_type;
+
+    explicit BlockArena(const Alloc& a = Alloc())
+        : _chunk(0), _slab_chunks(0), _chunks(0), _huge_pages(false), _next(0), _slab_end(0),
+        _slabs(typename SlabVec::allocator_type(a)), _free(typename TPtrVec::allocator_type(a)), _a(a) {}
+    BlockArena(BlockArena<T, Alloc>&& ba) noexcept;
+    ~BlockArena()
+        { _release(); }
+    BlockArena<T, Alloc>& operator=(BlockArena<T, Alloc>&& ba)
+        noexcept(AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value);
+
+    void reset(size_type chunk, size_type slab_chunks, bool huge_pages = false);
+
+    TPtr allocate();
+    void deallocate(TPtr chunk)
+        { _free.push_back(chunk); }
+
+    inline size_type chunk_size() const
+        { return _chunk; }
+    inline size_type slab_count() const
+        { return _slabs.size(); }
+    inline size_type capacity() const
+        { return _chunks; }
+    inline bool huge_pages() const
+        { return _huge_pages; }
+
+    void swap(BlockArena<T, Alloc>&);
+
+private:
+
+    BlockArena(const BlockArena<T, Alloc>&);
+    void operator=(const BlockArena<T, Alloc>&);
+
+    void _add_slab();
+    void _release();
+
+    size_type _chunk;
+    size_type _slab_chunks;
+    size_type _chunks;
+    bool _huge_pages;
+    TPtr _next;
+    TPtr _slab_end;
+    SlabVec _slabs;
+    TPtrVec _free;
+    Alloc _a;
+};
+
+/**
+    The slabs are taken from the given arena, which is left with no slabs.
+*/
+template <class T, class Alloc>
+BlockArena<T, Alloc>::BlockArena(BlockArena<T, Alloc>&& ba) noexcept
+    : _chunk(ba._chunk), _slab_chunks(ba._slab_chunks), _chunks(ba._chunks), _huge_pages(ba._huge_pages),
+    _next(ba._next), _slab_end(ba._slab_end), _slabs(std::move(ba._slabs)), _free(std::move(ba._free)), _a(ba._a)
+{
+    ba._slabs.clear();
+    ba._free.clear();
+    ba._chunks = 0;
+    ba._next = ba._slab_end = 0;
+}
+
+/**
+    The slabs are taken from the given arena, which is left with no slabs.
+    The allocators have to be equal unless the allocator propagates,
+    otherwise the owner moves the blocks to the chunks of its own arena.
+*/
+template <class T, class Alloc>
+BlockArena<T, Alloc>& BlockArena<T, Alloc>::operator=(BlockArena<T, Alloc>&& ba)
+    noexcept(AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value)
+{
+    if (this == &ba)
+        return *this;
+
+    _release();
+    _chunk = ba._chunk;
+    _slab_chunks = ba._slab_chunks;
+    _chunks = ba._chunks;
+    _huge_pages = ba._huge_pages;
+    _next = ba._next;
+    _slab_end = ba._slab_end;
+    _slabs = std::move(ba._slabs);
+    _free = std::move(ba._free);
+    alloc_move_assign(_a, ba._a);
+    ba._slabs.clear();
+    ba._free.clear();
+    ba._chunks = 0;
+    ba._next = ba._slab_end = 0;
+    return *this;
+}
+
+template <class T, class Alloc>
+void BlockArena<T, Alloc>::reset(size_type chunk, size_type slab_chunks, bool huge_pages)
+{
+    _release();
+    _chunk = chunk;
+    _slab_chunks = slab_chunks?slab_chunks:1;
+#ifdef _HUGE_PAGES
+    _huge_pages = huge_pages;
+#else
+    (void)huge_pages;
+#endif
+}
+
+template <class T, class Alloc>
+typename BlockArena<T, Alloc>::TPtr BlockArena<T, Alloc>::allocate()
+{
+    if (!_free.empty()) {
+        TPtr chunk = _free.back();
+        _free.pop_back();
+        return chunk;
+    }
+
+    if (_next == _slab_end)
+        _add_slab();
+
+    TPtr chunk = _next;
+    _next += _chunk;
+    return chunk;
+}
+
+template <class T, class Alloc>
+void BlockArena<T, Alloc>::swap(BlockArena<T, Alloc>& ba)
+{
+    std::swap(_chunk, ba._chunk);
+    std::swap(_slab_chunks, ba._slab_chunks);
+    std::swap(_chunks, ba._chunks);
+    std::swap(_huge_pages, ba._huge_pages);
+    std::swap(_next, ba._next);
+    std::swap(_slab_end, ba._slab_end);
+    _slabs.swap(ba._slabs);
+    _free.swap(ba._free);
+    alloc_swap(_a, ba._a);
+}
+
+template <class T, class Alloc>
+void BlockArena<T, Alloc>::_add_slab()
+{
+    //The first slab is as requested, every next one doubles the total capacity
+    size_type chunks = _chunks?_chunks:_slab_chunks;
+#ifdef _HUGE_PAGES
+    if (_huge_pages) {
+        chunks = huge_pages_round(chunks*_chunk*sizeof(T))/(_chunk*sizeof(T));
+        _next = static_cast<TPtr>(huge_pages_allocate(chunks*_chunk*sizeof(T)));
+    }
+    else
+#endif
+        _next = AllocTraits::allocate(_a, chunks*_chunk);
+    size_type n = chunks*_chunk;
+    _slab_end = _next + n;
+    _slabs.push_back(Slab(_next, n));
+    _chunks += chunks;
+}
+
+template <class T, class Alloc>
+void BlockArena<T, Alloc>::_release()
+{
+    for (typename SlabVec::iterator it = _slabs.begin(); it != _slabs.end(); ++it)
+#ifdef _HUGE_PAGES
+        if (_huge_pages)
+            huge_pages_deallocate(it->first, it->second*sizeof(T));
+        else
+#endif
+            AllocTraits::deallocate(_a, it->first, it->second);
+    _slabs.clear();
+    _free.clear();
+    _chunks = 0;
+    _next = _slab_end = 0;
+}
+
+#endif
@@ -0,0 +1,224 @@
+/**
+    @author Eduard Igushev visit <www.igushev.com> e-mail <eduard@igushev.com>
+    @brief Element counts of blocks of variable size
+
+    The BlockCounts class keeps the number of elements of every block
+    and finds the block which holds an element with the given number.
+    The counts are kept either as prefix sums or in a Fenwick tree.
+    Prefix sums are read in constant time, but changing the count of a block
+    changes the sums of all next blocks. A Fenwick tree reads and changes
+    the counts in O(log B) time, where B is the number of blocks.
+
+    Inserting or erasing a block rebuilds the counts from this block in both cases,
+    which takes O(B) time like the insertion or the erasure in the block directory.
+
+    Warranty and license
+    The implementation is provided “as it is” with no warranty.
+    Any private and commercial usage is allowed.
+    Keeping the original name and link to the source is required.
+    Any feedback is welcomed :-)
+*/
+
+#ifndef _BlockCounts_h
+#define _BlockCounts_h
+
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+template <class Alloc = std::allocator<size_t> >
+class BlockCounts {
+
+public:
+
+    typedef typename std::allocator_traits<Alloc>::size_type size_type;
+    typedef typename std::allocator_traits<Alloc>::difference_type difference_type;
+
+private:
+
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<size_type> SizeAlloc;
+    typedef std::vector<size_type, SizeAlloc> SizeVec;
+
+public:
+
+    explicit BlockCounts(const Alloc& a = Alloc())
+        : _t(SizeAlloc(a)), _fenwick(false), _total(0) {}
+
+    void reset(bool fenwick);
+
+    inline size_type blocks() const
+        { return _t.size() - 1; }
+    inline size_type total() const
+        { return _total; }
+    size_type before(size_type i) const;
+    size_type find(size_type n, size_type& offset) const;
+
+    void add(size_type i, difference_type n);
+    void shift(size_type i, difference_type n);
+    void push_back(size_type n);
+    void pop_back();
+    template <class BlockIterator>
+    void recount(size_type i, BlockIterator first, BlockIterator last);
+
+    inline size_type capacity() const
+        { return _t.capacity(); }
+    void swap(BlockCounts<Alloc>&);
+
+private:
+
+    inline static size_type _low_bit(size_type i)
+        { return i & (~i + 1); }
+    void _add(size_type i, difference_type n);
+
+    //Prefix sums: the number of elements before every block and the total one
+    //Fenwick tree: the sums of ranges of blocks numbered from 1
+    SizeVec _t;
+    bool _fenwick;
+    size_type _total;
+};
+
+template <class Alloc>
+void BlockCounts<Alloc>::reset(bool fenwick)
+{
+    _fenwick = fenwick;
+    _t.assign(1, 0);
+    _total = 0;
+}
+
+template <class Alloc>
+typename BlockCounts<Alloc>::size_type BlockCounts<Alloc>::before(size_type i) const
+{
+    if (!_fenwick)
+        return _t[i];
+
+    size_type n = 0;
+    for (; i; i -= _low_bit(i))
+        n += _t[i];
+    return n;
+}
+
+/**
+    Returns the block which holds the element with the given number
+    and the number of the element in the block.
+    The number equal to the total count is found in the last block.
+*/
+template <class Alloc>
+typename BlockCounts<Alloc>::size_type BlockCounts<Alloc>::find(size_type n, size_type& offset) const
+{
+    size_type i;
+    if (!_fenwick) {
+        i = std::upper_bound(_t.begin(), _t.end() - 1, n) - _t.begin() - 1;
+        offset = n - _t[i];
+        return i;
+    }
+
+    //Go down the tree taking every range that ends before the element
+    size_type bit = 1;
+    while (bit*2 <= blocks())
+        bit *= 2;
+    i = 0;
+    for (; bit; bit /= 2)
+        if (i + bit <= blocks() && _t[i + bit] <= n) {
+            i += bit;
+            n -= _t[i];
+        }
+
+    //The end is in the last block
+    if (i == blocks()) {
+        --i;
+        n += _total - before(i);
+    }
+    offset = n;
+    return i;
+}
+
+template <class Alloc>
+void BlockCounts<Alloc>::add(size_type i, difference_type n)
+{
+    _total += n;
+    if (_fenwick)
+        _add(i, n);
+    else
+        for (typename SizeVec::iterator it = _t.begin() + i + 1; it != _t.end(); ++it)
+            *it += n;
+}
+
+/**
+    Moves the count from the block to the next one.
+*/
+template <class Alloc>
+void BlockCounts<Alloc>::shift(size_type i, difference_type n)
+{
+    if (_fenwick) {
+        _add(i, -n);
+        _add(i + 1, n);
+    }
+    else
+        _t[i + 1] -= n;
+}
+
+template <class Alloc>
+void BlockCounts<Alloc>::push_back(size_type n)
+{
+    if (_fenwick) {
+        //The new node sums the ranges of the nodes it covers
+        size_type i = _t.size();
+        _t.push_back(n + before(i - 1) - before(i - _low_bit(i)));
+    }
+    else
+        _t.push_back(_t.back() + n);
+    _total += n;
+}
+
+template <class Alloc>
+void BlockCounts<Alloc>::pop_back()
+{
+    _total -= before(blocks()) - before(blocks() - 1);
+    _t.pop_back();
+}
+
+/**
+    Recounts blocks from the given one after blocks have been inserted or erased.
+    The range is all the blocks.
+*/
+template <class Alloc>
+template <class BlockIterator>
+void BlockCounts<Alloc>::recount(size_type i, BlockIterator first, BlockIterator last)
+{
+    size_type n = last - first;
+    _t.resize(n + 1);
+    if (!_fenwick) {
+        for (; i < n; ++i)
+            _t[i + 1] = _t[i] + first[i].size();
+        _total = _t.back();
+        return;
+    }
+
+    //Nodes up to the block stay, the ones which sum its prefix are added to their parents after it
+    for (size_type j = i + 1; j <= n; ++j)
+        _t[j] = first[j - 1].size();
+    for (size_type j = i; j; j -= _low_bit(j))
+        if (j + _low_bit(j) <= n)
+            _t[j + _low_bit(j)] += _t[j];
+    for (size_type j = i + 1; j <= n; ++j)
+        if (j + _low_bit(j) <= n)
+            _t[j + _low_bit(j)] += _t[j];
+    _total = before(n);
+}
+
+template <class Alloc>
+void BlockCounts<Alloc>::swap(BlockCounts<Alloc>& bc)
+{
+    _t.swap(bc._t);
+    std::swap(_fenwick, bc._fenwick);
+    std::swap(_total, bc._total);
+}
+
+template <class Alloc>
+void BlockCounts<Alloc>::_add(size_type i, difference_type n)
+{
+    for (++i; i < _t.size(); i += _low_bit(i))
+        _t[i] += n;
+}
+
+#endif
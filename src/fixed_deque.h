@@ -7,6 +7,12 @@
     It does not totally implements std::deque interface
     and provides only functions needed by IgushArray implementation.
 
+    The deque is kept compact since IgushArray stores deques by value in its directory:
+    the storage pointer, the capacity, the offset of the first element, the size
+    and whether the storage is owned.
+    The size is stored explicitly, so no slot of the ring is wasted to tell full from empty.
+    Stateless allocators take no space (empty base).
+
     Warranty and license
     The implementation is provided “as it is” with no warranty.
     Any private and commercial usage is allowed.
@@ -19,11 +25,17 @@
 
 #include <memory>
 #include <stdexcept>
+#include <utility>
+#include <type_traits>
+#include <cstring>
+#include <algorithm>
 #include "size_helper.h"
+#include "alloc_helper.h"
 
 template <class T, class Alloc = std::allocator<T> >
-class FixedDeque {
+class FixedDeque : private Alloc {
 
+    typedef std::allocator_traits<Alloc> AllocTraits;
     typedef T* TPtr;
     typedef const T* TPtrConst;
     typedef FixedDeque<T, Alloc>* SelfPtr;
@@ -33,25 +45,24 @@ public:
 
     typedef Alloc allocator_type;
 
-    typedef typename Alloc::size_type size_type;
-    typedef typename Alloc::difference_type difference_type;
+    typedef typename AllocTraits::size_type size_type;
+    typedef typename AllocTraits::difference_type difference_type;
     typedef T value_type;
     typedef const T const_value_type;
 
-    typedef typename Alloc::reference reference;
-    typedef typename Alloc::const_reference const_reference;
-    typedef typename Alloc::pointer pointer;
-    typedef typename Alloc::const_pointer const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef typename AllocTraits::pointer pointer;
+    typedef typename AllocTraits::const_pointer const_pointer;
 
     template <class U, class FixedDequePtr>
     class FixedDequeIterator {
 
-        typedef U* UPtr;
         typedef FixedDequeIterator<U, FixedDequePtr> Self;
         typedef FixedDequeIterator<const T, SelfConstPtr> SelfConst;
 
-        FixedDequeIterator(FixedDequePtr fd, UPtr u) :_fd(fd), _u(u) {}
-    
+        FixedDequeIterator(FixedDequePtr fd, size_type n) :_fd(fd), _n(n) {}
+
     public:
 
         typedef std::random_access_iterator_tag iterator_category;
@@ -61,49 +72,59 @@ public:
         typedef U& reference;
         typedef U* pointer;
 
-        Self& operator++();
-        Self operator++(int);
-        Self& operator--();
-        Self operator--(int);
-
-        Self& operator+=(difference_type);
-        Self operator+(difference_type) const;
-        Self& operator-=(difference_type);
-        Self operator-(difference_type) const;
-
-        inline difference_type operator-(const Self& fdi) const;
-
-        inline U& operator*()
-            { return *_u; }
-        inline U* operator->()
-            { return &(*_u); }
+        FixedDequeIterator()
+            :_fd(0), _n(0) {}
+
+        inline Self& operator++()
+            { ++_n; return *this; }
+        inline Self operator++(int)
+            { Self temp = *this; ++*this; return temp; }
+        inline Self& operator--()
+            { --_n; return *this; }
+        inline Self operator--(int)
+            { Self temp = *this; --*this; return temp; }
+
+        inline Self& operator+=(difference_type incr)
+            { _n += incr; return *this; }
+        inline Self operator+(difference_type incr) const
+            { Self temp = *this; temp += incr; return temp; }
+        inline Self& operator-=(difference_type decr)
+            { _n -= decr; return *this; }
+        inline Self operator-(difference_type decr) const
+            { Self temp = *this; temp -= decr; return temp; }
+
+        inline difference_type operator-(const Self& fdi) const
+            { return (difference_type)_n - (difference_type)fdi._n; }
+
+        inline U& operator*() const
+            { return (*_fd)[_n]; }
+        inline U* operator->() const
+            { return &(*_fd)[_n]; }
+        inline U& operator[](difference_type n) const
+            { return *(*this + n); }
+        friend inline Self operator+(difference_type n, const Self& it)
+            { return it + n; }
 
         inline bool operator==(const Self& fdi) const
-            { return _u == fdi._u; }
+            { return _n == fdi._n; }
         inline bool operator!=(const Self& fdi) const
             { return !(*this == fdi); }
-        inline bool operator<(const Self& fdi) const;
+        inline bool operator<(const Self& fdi) const
+            { return _n < fdi._n; }
         inline bool operator<=(const Self& fdi) const
-            { return (*this < fdi || *this == fdi); }
-        inline bool operator>(const Self& fdi) const;
+            { return _n <= fdi._n; }
+        inline bool operator>(const Self& fdi) const
+            { return _n > fdi._n; }
         inline bool operator>=(const Self& fdi) const
-            { return (*this > fdi || *this == fdi); }
+            { return _n >= fdi._n; }
 
-        inline operator SelfConst()
-            { return SelfConst(_fd, _u); }
+        inline operator SelfConst() const
+            { return SelfConst(_fd, _n); }
 
     private:
 
-        static inline bool _special_lower(const Self& fdi1, const Self& fdi2)
-            {
-                return (fdi1._fd == fdi2._fd &&
-                    fdi1._u >= fdi1._fd->_begin &&
-                    fdi1._fd->_begin > fdi2._fd->_end &&
-                    fdi2._fd->_end >= fdi2._u);
-            }
-
         FixedDequePtr _fd;
-        UPtr _u;
+        size_type _n;
 
         friend class FixedDeque<T, Alloc>;
     };
@@ -112,23 +133,31 @@ public:
     typedef FixedDequeIterator<const T, SelfConstPtr> const_iterator;
     //typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
     //typedef std::reverse_iterator<iterator> reverse_iterator;
-    
+
     explicit FixedDeque(size_type n, const Alloc& a = Alloc());
+    FixedDeque(size_type n, TPtr storage, const Alloc& a = Alloc());
+    FixedDeque(FixedDeque<T, Alloc>&& fd) noexcept;
+    FixedDeque(FixedDeque<T, Alloc>&& fd, const Alloc& alloc);
     ~FixedDeque();
-    
+    FixedDeque<T, Alloc>& operator=(FixedDeque<T, Alloc>&& fd)
+        noexcept(AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value);
+
     inline bool empty() const
-        { return (_begin == _end); }
-    inline size_type size() const;
+        { return !_size; }
+    inline size_type size() const
+        { return _size; }
+    inline size_type max_size() const
+        { return _capacity; }
     void resize(size_type n, const T& value = T());
 
     inline iterator begin()
-        { return iterator(this, _begin); }
+        { return iterator(this, 0); }
     inline const_iterator begin() const
-        { return const_iterator(this, _begin); }
+        { return const_iterator(this, 0); }
     inline iterator end()
-        { return iterator(this, _end); }
+        { return iterator(this, _size); }
     inline const_iterator end() const
-        { return const_iterator(this, _end); }
+        { return const_iterator(this, _size); }
 
     /*inline reverse_iterator rbegin()
         { return reverse_iterator(end()); }
@@ -139,240 +168,204 @@ public:
     inline const_reverse_iterator rend() const
         { return const_reverse_iterator(begin()); }*/
 
-    reference operator[](size_type);
-    const_reference operator[](size_type) const;
+    inline reference operator[](size_type n)
+        { return _storage[_wrap(_begin + n)]; }
+    inline const_reference operator[](size_type n) const
+        { return _storage[_wrap(_begin + n)]; }
     reference at(size_type);
     const_reference at(size_type) const;
 
     inline reference front()
-        { return *_begin; }
+        { return _storage[_begin]; }
     inline const_reference front() const
-        { return *_begin; }
+        { return _storage[_begin]; }
     inline reference back()
-        { return *(end()-1); }
+        { return (*this)[_size - 1]; }
     inline const_reference back() const
-        { return *(end()-1); }
-
-    void push_back(const T&);
+        { return (*this)[_size - 1]; }
+
+    inline void push_back(const T& val)
+        { emplace_back(val); }
+    inline void push_back(T&& val)
+        { emplace_back(std::move(val)); }
+    template <class... Args>
+    void emplace_back(Args&&... args);
     void pop_back();
-    void push_front(const T&);
+    inline void push_front(const T& val)
+        { emplace_front(val); }
+    inline void push_front(T&& val)
+        { emplace_front(std::move(val)); }
+    template <class... Args>
+    void emplace_front(Args&&... args);
     void pop_front();
 
-    iterator insert(iterator, const T&);
+    inline iterator insert(iterator it, const T& val)
+        { return emplace(it, val); }
+    inline iterator insert(iterator it, T&& val)
+        { return emplace(it, std::move(val)); }
+    template <class... Args>
+    iterator emplace(iterator, Args&&... args);
     template <class InputIterator>
     iterator insert(iterator, InputIterator first, InputIterator last);
     iterator erase(iterator);
     iterator erase(iterator, iterator);
-    
+
     void clear();
-    inline Alloc get_allocator()
-        { return _alloc; }
+    TPtr release();
+    inline Alloc get_allocator() const
+        { return *this; }
 
 private:
+
+    FixedDeque(const FixedDeque<T, Alloc>&);
+    void operator=(const FixedDeque<T, Alloc>&);
+
+    inline Alloc& _alloc()
+        { return *this; }
+    inline size_type _wrap(size_type i) const
+        { return (i < _capacity)?i:i - _capacity; }
+    inline TPtr _ptr(size_type n)
+        { return _storage + _wrap(_begin + n); }
+    //Access for a ring whose capacity is a power of two, mask is capacity - 1
+    inline reference _masked(size_type n, size_type mask)
+        { return _storage[(_begin + n) & mask]; }
+    inline const_reference _masked(size_type n, size_type mask) const
+        { return _storage[(_begin + n) & mask]; }
+    //The contiguous piece of the ring with the element: its start, the element and its end
+    template <class Ptr>
+    inline void _piece(size_type n, Ptr& first, Ptr& p, Ptr& last) const
+    {
+        if (_begin + n < _capacity) {
+            first = _storage + _begin;
+            p = _storage + _begin + n;
+            last = _storage + std::min(_begin + _size, _capacity);
+        }
+        else {
+            first = _storage;
+            p = _storage + (_begin + n - _capacity);
+            last = _storage + (_begin + _size - _capacity);
+        }
+    }
     void _destroy(TPtr begin, TPtr end)
-        { while (begin != end) _alloc.destroy(begin++); }
-    size_type _max_size() const
-        { return (_storage_end - _storage_begin - 1); }
-    void _move(iterator, const T&);
-    void _increase_begin(difference_type n);
-    void _increase_end(difference_type n);
-    void _decrease_begin(difference_type n);
-    void _decrease_end(difference_type n);
-
-    TPtr _storage_begin;
-    TPtr _storage_end;
-    TPtr _begin;
-    TPtr _end;
-    Alloc _alloc;
+        { while (begin != end) AllocTraits::destroy(_alloc(), begin++); }
+    template <class V>
+    void _move(size_type to, V&& val);
+    inline void _shift(size_type from, size_type to, size_type n)
+        { _shift(from, to, n, std::is_trivially_copyable<T>()); }
+    void _shift(size_type from, size_type to, size_type n, std::true_type);
+    void _shift(size_type from, size_type to, size_type n, std::false_type);
+
+    template <class Function>
+    inline void _for_pieces(Function& f)
+        { _for_pieces(f, 0, _size); }
+    template <class Function>
+    inline void _for_pieces(Function& f) const
+        { _for_pieces(f, 0, _size); }
+    template <class Function>
+    void _for_pieces(Function& f, size_type from, size_type to);
+    template <class Function>
+    void _for_pieces(Function& f, size_type from, size_type to) const;
+    template <class InputIterator>
+    void _append(InputIterator& first, size_type n);
+    void _copy(const FixedDeque<T, Alloc>& fd);
+    void _take(FixedDeque<T, Alloc>& fd);
+
+    void _rotate_front(T& carry);
+    void _rotate_back(T& carry);
+    void _insert_full(size_type n, T& carry);
+    void _erase_full(size_type n, T& carry);
+
+    TPtr _storage;
+    size_type _capacity;
+    size_type _begin;
+    size_type _size;
+    bool _owns;
+
+    template <class, class> friend class IgushArray;
+    template <class, class, class> friend class TieredDeque;
 };
- 
-template <class T, class Alloc>
-template <class U, class FixedDequePtr>
-typename FixedDeque<T, Alloc>::template FixedDequeIterator<U, FixedDequePtr>&
-FixedDeque<T, Alloc>::FixedDequeIterator<U, FixedDequePtr>::operator+=(difference_type incr)
-{
-    _u += incr;
-    if (_u > _fd->_storage_end - 1)
-        _u -= (_fd->_storage_end - _fd->_storage_begin);
-    return *this;
-}
-
-template <class T, class Alloc>
-template <class U, class FixedDequePtr>
-typename FixedDeque<T, Alloc>::template FixedDequeIterator<U, FixedDequePtr>
-FixedDeque<T, Alloc>::FixedDequeIterator<U, FixedDequePtr>::operator+(difference_type incr) const
-{
-    Self temp = *this;
-    temp += incr;
-    return temp;
-}
-
-template <class T, class Alloc>
-template <class U, class FixedDequePtr>
-typename FixedDeque<T, Alloc>::template FixedDequeIterator<U, FixedDequePtr>&
-FixedDeque<T, Alloc>::FixedDequeIterator<U, FixedDequePtr>::operator-=(difference_type decr)
-{
-    _u -= decr;
-    if (_u < _fd->_storage_begin)
-        _u += (_fd->_storage_end - _fd->_storage_begin);
-    return *this;
-}
-
-template <class T, class Alloc>
-template <class U, class FixedDequePtr>
-typename FixedDeque<T, Alloc>::template FixedDequeIterator<U, FixedDequePtr>
-FixedDeque<T, Alloc>::FixedDequeIterator<U, FixedDequePtr>::operator-(difference_type decr) const
-{
-    Self temp = *this;
-    temp -= decr;
-    return temp;
-}
 
 template <class T, class Alloc>
-template <class U, class FixedDequePtr>
-typename FixedDeque<T, Alloc>::template FixedDequeIterator<U, FixedDequePtr>&
-FixedDeque<T, Alloc>::FixedDequeIterator<U, FixedDequePtr>::operator++()
-{
-    ++_u;
-    if (_u > _fd->_storage_end - 1)
-        _u -= (_fd->_storage_end - _fd->_storage_begin);
-    return *this;
-}
-
-template <class T, class Alloc>
-template <class U, class FixedDequePtr>
-typename FixedDeque<T, Alloc>::template FixedDequeIterator<U, FixedDequePtr>
-FixedDeque<T, Alloc>::FixedDequeIterator<U, FixedDequePtr>::operator++(int)
-{
-    Self temp = *this;
-    ++*this;
-    return temp;
-}
-
-template <class T, class Alloc>
-template <class U, class FixedDequePtr>
-typename FixedDeque<T, Alloc>::template FixedDequeIterator<U, FixedDequePtr>&
-FixedDeque<T, Alloc>::FixedDequeIterator<U, FixedDequePtr>::operator--()
-{
-    --_u;
-    if (_u < _fd->_storage_begin)
-        _u += (_fd->_storage_end - _fd->_storage_begin);
-    return *this;
-}
-
-template <class T, class Alloc>
-template <class U, class FixedDequePtr>
-typename FixedDeque<T, Alloc>::template FixedDequeIterator<U, FixedDequePtr>
-FixedDeque<T, Alloc>::FixedDequeIterator<U, FixedDequePtr>::operator--(int)
-{
-    Self temp = *this;
-    --*this;
-    return temp;
-}
-
-template <class T, class Alloc>
-template <class U, class FixedDequePtr>
-/*inline*/ typename FixedDeque<T, Alloc>::template FixedDequeIterator<U, FixedDequePtr>::difference_type
-FixedDeque<T, Alloc>::FixedDequeIterator<U, FixedDequePtr>::operator-(const Self& fdi) const
+/*explicit*/ FixedDeque<T, Alloc>::FixedDeque(size_type n, const Alloc& alloc)
+    : Alloc(alloc), _capacity(n), _begin(0), _size(0), _owns(true)
 {
-    difference_type res = _u - fdi._u;
-    if (_special_lower(*this, fdi))
-        res -= (_fd->_storage_end - _fd->_storage_begin);
-    else if (_special_lower(fdi, *this))
-        res += (_fd->_storage_end - _fd->_storage_begin);
-    return res;
+    _storage = AllocTraits::allocate(_alloc(), n);
 }
 
+/**
+    The deque uses given storage of n elements instead of allocating it.
+    The storage is not owned by the deque: the owner takes it back by release(),
+    a deque destroyed without it only destroys the elements.
+*/
 template <class T, class Alloc>
-template <class U, class FixedDequePtr>
-/*inline*/ bool FixedDeque<T, Alloc>::FixedDequeIterator<U, FixedDequePtr>::operator<(const Self& fdi) const
+FixedDeque<T, Alloc>::FixedDeque(size_type n, TPtr storage, const Alloc& alloc)
+    : Alloc(alloc), _storage(storage), _capacity(n), _begin(0), _size(0), _owns(false)
 {
-    if (_special_lower(*this, fdi))
-        return true;
-    else if (_special_lower(fdi, *this))
-        return false;
-    else
-        return (_u < fdi._u);
 }
 
 template <class T, class Alloc>
-template <class U, class FixedDequePtr>
-/*inline*/ bool FixedDeque<T, Alloc>::FixedDequeIterator<U, FixedDequePtr>::operator>(const Self& fdi) const
+FixedDeque<T, Alloc>::FixedDeque(FixedDeque<T, Alloc>&& fd) noexcept
+    : Alloc(fd), _storage(fd._storage), _capacity(fd._capacity), _begin(fd._begin), _size(fd._size), _owns(fd._owns)
 {
-    if (_special_lower(*this, fdi))
-        return false;
-    else if (_special_lower(fdi, *this))
-        return true;
-    else
-        return (_u > fdi._u);
+    fd._storage = 0;
+    fd._capacity = fd._begin = fd._size = 0;
 }
 
+/**
+    The deque with the given allocator, which is used by containers of deques.
+    The storage is taken if the allocators are equal, otherwise the elements are moved.
+*/
 template <class T, class Alloc>
-/*explicit*/ FixedDeque<T, Alloc>::FixedDeque(size_type n, const Alloc& alloc)
-    : _alloc(alloc)
+FixedDeque<T, Alloc>::FixedDeque(FixedDeque<T, Alloc>&& fd, const Alloc& alloc)
+    : Alloc(alloc)
 {
-    _begin = _end = _storage_begin = _alloc.allocate(n + 1);
-    _storage_end = _storage_begin + n + 1;
+    _take(fd);
 }
 
 template <class T, class Alloc>
 FixedDeque<T, Alloc>::~FixedDeque()
 {
-    clear();
-    _alloc.deallocate(_storage_begin, _storage_end - _storage_begin);
+    if (_storage) {
+        clear();
+        if (_owns)
+            AllocTraits::deallocate(_alloc(), _storage, _capacity);
+    }
 }
 
 template <class T, class Alloc>
-/*inline*/ typename FixedDeque<T, Alloc>::size_type FixedDeque<T, Alloc>::size() const
+FixedDeque<T, Alloc>& FixedDeque<T, Alloc>::operator=(FixedDeque<T, Alloc>&& fd)
+    noexcept(AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value)
 {
-    difference_type result = _end - _begin;
-    if (result < 0)
-        result += _storage_end - _storage_begin;
+    if (this == &fd)
+        return *this;
+
+    if (_storage) {
+        clear();
+        if (_owns)
+            AllocTraits::deallocate(_alloc(), _storage, _capacity);
+        _storage = 0;
+    }
 
-    return result;
+    alloc_move_assign(_alloc(), fd._alloc());
+    _take(fd);
+    return *this;
 }
 
 template <class T, class Alloc>
 void FixedDeque<T, Alloc>::resize(size_type n, const T& value/* = T()*/)
 {
-    if (n > size()) {
-        if (n > _max_size())
+    if (n > _size) {
+        if (n > _capacity)
             throw std::out_of_range("resize(): The size has been exceeded");
-        iterator it = end();
-        unsigned new_elems = n - size();
-        for (unsigned i = 0; i < new_elems; ++i)
-            _move(it++, value);
-        _increase_end(new_elems);
+        while (_size < n)
+            AllocTraits::construct(_alloc(), _ptr(_size++), value);
     }
-    else if (n < size()) {
-        iterator it = end();
-        unsigned del_elems = size() - n;
-        for (unsigned i = 0; i < del_elems; ++i)
-            _alloc.destroy((--it)._u);
-        _decrease_end(del_elems);
+    else {
+        while (_size > n)
+            AllocTraits::destroy(_alloc(), _ptr(--_size));
     }
 }
 
-template <class T, class Alloc>
-typename FixedDeque<T, Alloc>::reference FixedDeque<T, Alloc>::operator[](size_type n)
-{
-    TPtr result = _begin;
-    result += n;
-    if (result > _storage_end - 1)
-        result -= (_storage_end - _storage_begin);
-    return *result;
-}
-
-template <class T, class Alloc>
-typename FixedDeque<T, Alloc>::const_reference FixedDeque<T, Alloc>::operator[](size_type n) const
-{
-    TPtrConst result = _begin;
-    result += n;
-    if (result > _storage_end - 1)
-        result -= (_storage_end - _storage_begin);
-    return *result;
-}
-
 template <class T, class Alloc>
 typename FixedDeque<T, Alloc>::reference FixedDeque<T, Alloc>::at(size_type n)
 {
@@ -390,80 +383,88 @@ typename FixedDeque<T, Alloc>::const_reference FixedDeque<T, Alloc>::at(size_typ
 }
 
 template <class T, class Alloc>
-void FixedDeque<T, Alloc>::push_back(const T& val)
+template <class... Args>
+void FixedDeque<T, Alloc>::emplace_back(Args&&... args)
 {
-    if (size() == _max_size())
-        throw std::out_of_range("push_back(): The size has been exceeded");
+    if (_size == _capacity)
+        throw std::out_of_range("emplace_back(): The size has been exceeded");
 
-    _alloc.construct(_end, val);
-
-    if (_end == _storage_end - 1)
-        _end = _storage_begin;
-    else
-        ++_end;
+    AllocTraits::construct(_alloc(), _ptr(_size), std::forward<Args>(args)...);
+    ++_size;
 }
 
 template <class T, class Alloc>
 void FixedDeque<T, Alloc>::pop_back()
 {
-    if (_begin == _end)
+    if (!_size)
         throw std::out_of_range("pop_back(): The size has been exceeded");
 
-    if (_end == _storage_begin)
-        _end = _storage_end - 1;
-    else
-        --_end;
-
-    _alloc.destroy(_end);
+    AllocTraits::destroy(_alloc(), _ptr(--_size));
 }
 
 template <class T, class Alloc>
-void FixedDeque<T, Alloc>::push_front(const T& val)
+template <class... Args>
+void FixedDeque<T, Alloc>::emplace_front(Args&&... args)
 {
-    if (size() == _max_size())
-        throw std::out_of_range("push_front(): Container is empty");
+    if (_size == _capacity)
+        throw std::out_of_range("emplace_front(): The size has been exceeded");
 
-    if (_begin == _storage_begin)
-        _begin = _storage_end - 1;
-    else
-        --_begin;
-
-    _alloc.construct(_begin, val);
+    size_type begin = (_begin?_begin:_capacity) - 1;
+    AllocTraits::construct(_alloc(), _storage + begin, std::forward<Args>(args)...);
+    _begin = begin;
+    ++_size;
 }
 
 template <class T, class Alloc>
 void FixedDeque<T, Alloc>::pop_front()
 {
-    if (_begin == _end)
+    if (!_size)
         throw std::out_of_range("pop_front(): Container is empty");
 
-    _alloc.destroy(_begin);
-
-    if (_begin == _storage_end - 1)
-        _begin = _storage_begin;
-    else
-        ++_begin;
+    AllocTraits::destroy(_alloc(), _storage + _begin);
+    _begin = _wrap(_begin + 1);
+    --_size;
 }
 
+/**
+    The new element is created before the elements are shifted,
+    so the arguments may refer to elements of the deque.
+*/
 template <class T, class Alloc>
-typename FixedDeque<T, Alloc>::iterator FixedDeque<T, Alloc>::insert(iterator it, const T& val)
+template <class... Args>
+typename FixedDeque<T, Alloc>::iterator FixedDeque<T, Alloc>::emplace(iterator it, Args&&... args)
 {
-    if (size() + 1 > _max_size())
-        throw std::out_of_range("insert(): The size has been exceeded");
-
-    iterator to = end() + 1;
-    iterator from = end();
-    while (from != it)
-        _move(--to, *--from);
+    if (_size == _capacity)
+        throw std::out_of_range("emplace(): The size has been exceeded");
 
-    _move(from, val);
+    size_type n = it._n;
 
-    if (_end == _storage_end - 1)
-        _end = _storage_begin;
-    else
-        ++_end;
+    if (!n) {
+        emplace_front(std::forward<Args>(args)...);
+    }
+    else if (n == _size) {
+        emplace_back(std::forward<Args>(args)...);
+    }
+    else {
+        T val(std::forward<Args>(args)...);
+
+        //Shift the shorter part of the ring
+        if (n < _size/2) {
+            size_type begin = (_begin?_begin:_capacity) - 1;
+            AllocTraits::construct(_alloc(), _storage + begin, std::move(*_ptr(0)));
+            _begin = begin;
+            ++_size;
+            _shift(2, 1, n - 1);
+        }
+        else {
+            AllocTraits::construct(_alloc(), _ptr(_size), std::move(*_ptr(_size - 1)));
+            ++_size;
+            _shift(n, n + 1, _size - 2 - n);
+        }
+        *_ptr(n) = std::move(val);
+    }
 
-    return from;
+    return iterator(this, n);
 }
 
 template <class T, class Alloc>
@@ -471,22 +472,20 @@ template <class InputIterator>
 typename FixedDeque<T, Alloc>::iterator FixedDeque<T, Alloc>::insert(iterator it, InputIterator first, InputIterator last)
 {
     size_type n = data_size(first, last);
-    if (size() + n > _max_size())
+    if (_size + n > _capacity)
         throw std::out_of_range("insert(): The size has been exceeded");
+    if (!n)
+        return it;
 
-    iterator to = end() + n;
-    iterator from = end();
-    while (from != it)
-        _move(--to, *--from);
+    size_type from = it._n;
+    _shift(from, from + n, _size - from);
 
-    iterator result = from;
-
-    while (first != last)
+    for (size_type i = 0; i < n; ++i)
         _move(from++, *first++);
 
-    _increase_end(n);
+    _size += n;
 
-    return result;
+    return it;
 }
 
 template <class T, class Alloc>
@@ -495,97 +494,278 @@ typename FixedDeque<T, Alloc>::iterator FixedDeque<T, Alloc>::erase(iterator it)
     if (empty())
         throw std::out_of_range("erase(): Container is empty");
 
-    iterator result = it;
-
-    iterator to = it;
-    iterator from = it + 1;
-    while (from != end())
-        *to++ = *from++;
+    size_type n = it._n;
 
-    if (_end == _storage_begin)
-        _end = _storage_end - 1;
-    else
-        --_end;
-
-    _alloc.destroy(_end);
+    //Shift the shorter part of the ring
+    if (n < _size/2) {
+        _shift(0, 1, n);
+        pop_front();
+    }
+    else {
+        _shift(n + 1, n, _size - n - 1);
+        pop_back();
+    }
 
-    return result;
+    return iterator(this, n);
 }
 
 template <class T, class Alloc>
 typename FixedDeque<T, Alloc>::iterator FixedDeque<T, Alloc>::erase(iterator first, iterator last)
 {
     size_type n = last - first;
-    if (size() < n)
+    if (_size < n)
         throw std::out_of_range("erase(): The size is not enough");
+    if (!n)
+        return first;
 
-    iterator result = first;
-    iterator to = first;
-    iterator from = last;
-    while (from != end())
-        *to++ = *from++;
+    size_type to = first._n + _size - last._n;
+    _shift(last._n, first._n, _size - last._n);
 
-    --to;
-    while (++to != end())
-        _alloc.destroy(to._u);
-    
-    _decrease_end(n);
+    while (_size != to)
+        AllocTraits::destroy(_alloc(), _ptr(--_size));
 
-    return result;
+    return first;
 }
 
 template <class T, class Alloc>
 void FixedDeque<T, Alloc>::clear()
 {
-    if (_begin > _end) {
-        _destroy(_begin, _storage_end);
-        _destroy(_storage_begin, _end);
+    if (_begin + _size > _capacity) {
+        _destroy(_storage + _begin, _storage + _capacity);
+        _destroy(_storage, _storage + _begin + _size - _capacity);
     }
     else {
-        _destroy(_begin, _end);
+        _destroy(_storage + _begin, _storage + _begin + _size);
     }
-    _begin = _end = _storage_begin;
+    _begin = _size = 0;
 }
 
+/**
+    Destroys all elements and gives the storage back to the caller.
+    The deque is left without storage and can only be destroyed or assigned.
+*/
 template <class T, class Alloc>
-void FixedDeque<T, Alloc>::_move(iterator it, const T& val)
+typename FixedDeque<T, Alloc>::TPtr FixedDeque<T, Alloc>::release()
 {
-    if (it >= end())
-        _alloc.construct(it._u, val);
+    clear();
+    TPtr storage = _storage;
+    _storage = 0;
+    _capacity = 0;
+    return storage;
+}
+
+template <class T, class Alloc>
+template <class V>
+void FixedDeque<T, Alloc>::_move(size_type to, V&& val)
+{
+    if (to >= _size)
+        AllocTraits::construct(_alloc(), _ptr(to), std::forward<V>(val));
     else
-        *it._u = val;
+        *_ptr(to) = std::forward<V>(val);
+}
+
+/**
+    Moves n elements from position from to position to, the ranges may overlap.
+    Trivially copyable elements are moved by memmove of contiguous pieces of the ring,
+    it is split at most at two wrap points, of the source and of the destination.
+    Positions past the size are constructed.
+*/
+template <class T, class Alloc>
+void FixedDeque<T, Alloc>::_shift(size_type from, size_type to, size_type n, std::true_type)
+{
+    if (from == to)
+        return;
+
+    while (n) {
+        size_type chunk;
+        if (to < from) {
+            size_type f = _wrap(_begin + from);
+            size_type t = _wrap(_begin + to);
+            chunk = std::min(n, std::min(_capacity - f, _capacity - t));
+            std::memmove(_storage + t, _storage + f, chunk*sizeof(T));
+            from += chunk;
+            to += chunk;
+        }
+        else {
+            size_type f = _wrap(_begin + from + n - 1) + 1;
+            size_type t = _wrap(_begin + to + n - 1) + 1;
+            chunk = std::min(n, std::min(f, t));
+            std::memmove(_storage + t - chunk, _storage + f - chunk, chunk*sizeof(T));
+        }
+        n -= chunk;
+    }
+}
+
+template <class T, class Alloc>
+void FixedDeque<T, Alloc>::_shift(size_type from, size_type to, size_type n, std::false_type)
+{
+    if (to < from) {
+        for (size_type i = 0; i < n; ++i)
+            _move(to + i, std::move(*_ptr(from + i)));
+    }
+    else if (to > from) {
+        for (size_type i = n; i-- > 0;)
+            _move(to + i, std::move(*_ptr(from + i)));
+    }
+}
+
+/**
+    Calls the function for the contiguous pieces of the elements from one number to another
+    in their order, the function takes the pointer to the first element of a piece and its size.
+    There are two pieces if the elements wrap around the end of the storage.
+*/
+template <class T, class Alloc>
+template <class Function>
+void FixedDeque<T, Alloc>::_for_pieces(Function& f, size_type from, size_type to)
+{
+    size_type start = _wrap(_begin + from);
+    size_type piece = std::min(to - from, _capacity - start);
+    if (piece)
+        f(_storage + start, piece);
+    if (to - from - piece)
+        f(_storage, to - from - piece);
 }
 
 template <class T, class Alloc>
-void FixedDeque<T, Alloc>::_increase_begin(difference_type n)
+template <class Function>
+void FixedDeque<T, Alloc>::_for_pieces(Function& f, size_type from, size_type to) const
 {
-    _begin -= n;
-    if (_begin < _storage_begin)
-        _begin += (_storage_end - _storage_begin);
+    size_type start = _wrap(_begin + from);
+    size_type piece = std::min(to - from, _capacity - start);
+    if (piece)
+        f((TPtrConst)_storage + start, piece);
+    if (to - from - piece)
+        f((TPtrConst)_storage, to - from - piece);
+}
+
+/**
+    Constructs n elements at the back without checks, the deque must have a room for them.
+    The elements are constructed straight in the pieces of the ring
+    up to the wrap point and from the start of the storage.
+*/
+template <class T, class Alloc>
+template <class InputIterator>
+void FixedDeque<T, Alloc>::_append(InputIterator& first, size_type n)
+{
+    while (n) {
+        TPtr to = _ptr(_size);
+        size_type piece = std::min(n, _capacity - (size_type)(to - _storage));
+        for (TPtr end = to + piece; to != end; ++to, ++_size)
+            AllocTraits::construct(_alloc(), to, *first++);
+        n -= piece;
+    }
 }
 
+/**
+    The deque must be empty and of the same capacity. The elements are copied
+    piece by piece keeping their places in the ring.
+*/
 template <class T, class Alloc>
-void FixedDeque<T, Alloc>::_increase_end(difference_type n)
+void FixedDeque<T, Alloc>::_copy(const FixedDeque<T, Alloc>& fd)
 {
-    _end += n;
-    if (_end > _storage_end - 1)
-        _end -= (_storage_end - _storage_begin);
+    size_type piece = std::min(fd._size, fd._capacity - fd._begin);
+    _begin = fd._begin;
+    for (_size = 0; _size < piece; ++_size)
+        AllocTraits::construct(_alloc(), _storage + _begin + _size, fd._storage[_begin + _size]);
+    for (; _size < fd._size; ++_size)
+        AllocTraits::construct(_alloc(), _storage + _size - piece, fd._storage[_size - piece]);
 }
 
+/**
+    Takes the storage of the deque, which is left without storage.
+    If the allocators differ, the storage is allocated and the elements are moved to it.
+*/
+template <class T, class Alloc>
+void FixedDeque<T, Alloc>::_take(FixedDeque<T, Alloc>& fd)
+{
+    if (_alloc() == fd._alloc() || !fd._storage) {
+        _storage = fd._storage;
+        _capacity = fd._capacity;
+        _begin = fd._begin;
+        _size = fd._size;
+        _owns = fd._owns;
+        fd._storage = 0;
+        fd._capacity = fd._begin = fd._size = 0;
+        return;
+    }
+
+    _storage = AllocTraits::allocate(_alloc(), fd._capacity);
+    _capacity = fd._capacity;
+    _begin = _size = 0;
+    _owns = true;
+    for (; _size < fd._size; ++_size)
+        AllocTraits::construct(_alloc(), _storage + _size, std::move(fd[_size]));
+    fd.clear();
+}
+
+/**
+    The deque must be full. The carried element becomes the first one
+    and the last element is carried out. The ring is just turned, so it takes constant time.
+*/
 template <class T, class Alloc>
-void FixedDeque<T, Alloc>::_decrease_begin(difference_type n)
+void FixedDeque<T, Alloc>::_rotate_front(T& carry)
 {
-    _begin += n;
-    if (_begin > _storage_end - 1)
-        _begin -= (_storage_end - _storage_begin);
+    using std::swap;
+    size_type begin = (_begin?_begin:_capacity) - 1;
+    swap(_storage[begin], carry);
+    _begin = begin;
 }
 
+/**
+    The deque must be full. The carried element becomes the last one
+    and the first element is carried out.
+*/
+template <class T, class Alloc>
+void FixedDeque<T, Alloc>::_rotate_back(T& carry)
+{
+    using std::swap;
+    swap(_storage[_begin], carry);
+    _begin = _wrap(_begin + 1);
+}
+
+/**
+    The deque must be full. The carried element is inserted at position n
+    and the last element is carried out.
+*/
 template <class T, class Alloc>
-void FixedDeque<T, Alloc>::_decrease_end(difference_type n)
+void FixedDeque<T, Alloc>::_insert_full(size_type n, T& carry)
 {
-    _end -= n;
-    if (_end < _storage_begin)
-        _end += (_storage_end - _storage_begin);
+    //Shift the shorter part of the ring
+    if (n < _size - n) {
+        _rotate_front(carry);
+        T val(std::move(*_ptr(0)));
+        _shift(1, 0, n);
+        *_ptr(n) = std::move(val);
+    }
+    else {
+        using std::swap;
+        swap(*_ptr(_size - 1), carry);
+        T val(std::move(*_ptr(_size - 1)));
+        _shift(n, n + 1, _size - 1 - n);
+        *_ptr(n) = std::move(val);
+    }
+}
+
+/**
+    The deque must be full. The element at position n is removed
+    and the carried element is added to the back, the removed one is carried out.
+*/
+template <class T, class Alloc>
+void FixedDeque<T, Alloc>::_erase_full(size_type n, T& carry)
+{
+    //Shift the shorter part of the ring
+    if (n < _size - n) {
+        T val(std::move(*_ptr(n)));
+        _shift(0, 1, n);
+        *_ptr(0) = std::move(val);
+        _rotate_back(carry);
+    }
+    else {
+        T val(std::move(*_ptr(n)));
+        _shift(n + 1, n, _size - n - 1);
+        *_ptr(_size - 1) = std::move(carry);
+        carry = std::move(val);
+    }
 }
 
 #endif
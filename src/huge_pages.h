@@ -0,0 +1,68 @@
+/**
+    @author Eduard Igushev visit <www.igushev.com> e-mail <eduard@igushev.com>
+    @brief Huge page storage
+
+    The functions map memory in 2MB pages for big storage accessed at random,
+    so one TLB entry covers 2MB instead of 4KB. Explicit huge pages (MAP_HUGETLB)
+    are asked first, the system gives them only if they are reserved.
+    Otherwise ordinary memory aligned on 2MB is mapped and transparent huge pages
+    are asked for it (MADV_HUGEPAGE), the system gives them if they are enabled,
+    or leaves ordinary pages. The size is always rounded up to whole huge pages.
+
+    The functions are defined only where mmap is, then _HUGE_PAGES is defined.
+
+    Warranty and license
+    The implementation is provided “as it is” with no warranty.
+    Any private and commercial usage is allowed.
+    Keeping the original name and link to the source is required.
+    Any feedback is welcomed :-)
+*/
+
+#ifndef _HUGE_PAGES_H
+#define _HUGE_PAGES_H
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <cstddef>
+#include <new>
+#define _HUGE_PAGES
+
+const std::size_t huge_page_size = 2*1024*1024;
+
+inline std::size_t huge_pages_round(std::size_t bytes)
+{
+    return (bytes + huge_page_size - 1)/huge_page_size*huge_page_size;
+}
+
+inline void* huge_pages_allocate(std::size_t bytes)
+{
+    bytes = huge_pages_round(bytes);
+#ifdef MAP_HUGETLB
+    void* p = mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p != MAP_FAILED)
+        return p;
+#endif
+
+    //One huge page more is mapped to cut the start and the end at huge page boundaries
+    char* q = static_cast<char*>(mmap(0, bytes + huge_page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (q == MAP_FAILED)
+        throw std::bad_alloc();
+    std::size_t head = (huge_page_size - reinterpret_cast<std::size_t>(q) % huge_page_size) % huge_page_size;
+    if (head)
+        munmap(q, head);
+    munmap(q + head + bytes, huge_page_size - head);
+    q += head;
+#ifdef MADV_HUGEPAGE
+    madvise(q, bytes, MADV_HUGEPAGE);
+#endif
+    return q;
+}
+
+inline void huge_pages_deallocate(void* p, std::size_t bytes)
+{
+    munmap(p, huge_pages_round(bytes));
+}
+
+#endif
+
+#endif
@@ -1,951 +1,2446 @@
-/**
-    @author Eduard Igushev visit <www.igushev.com> e-mail <eduard@igushev.com>
-    @brief Stability test pack for fixed deque
-
-    The IgushArray class totally implements std::vector interface.
-    IgushArray class totally provides iterator mechanism,
-    but this mechanism does not guarantee an iterator consistence after modifying operations
-    such as insert/erase, push back/pop back and so on.
-
-    Warranty and license
-    The implementation is provided “as it is” with no warranty.
-    Any private and commercial usage is allowed.
-    Keeping the original name and link to the source is required.
-    Any feedback is welcomed :-)
-*/
-
-#ifndef _IgushArray_h
-#define _IgushArray_h
-
-#define USE_FIXED_DEQUE
-
-#include <vector>
-#ifdef USE_FIXED_DEQUE
-#include "fixed_deque.h"
-#else
-#endif
-#include <deque>
-#include <iterator>
-#include <math.h>
-#include "size_helper.h"
-
-template <class T, class Alloc = std::allocator<T> >
-class IgushArray {
-
-    #ifdef USE_FIXED_DEQUE
-    typedef FixedDeque<T, Alloc> DeqT;
-    #else
-    typedef std::deque<T, Alloc> DeqT;
-    #endif
-    typedef typename DeqT::iterator DeqTIter;
-    typedef typename DeqT::const_iterator DeqTConstIter;
-    typedef DeqT* DeqTPtr; 
-
-    typedef std::vector<DeqTPtr> DeqTPtrVec;
-    typedef typename DeqTPtrVec::iterator DeqTPtrVecIter;
-    typedef typename DeqTPtrVec::const_iterator DeqTPtrVecConstIter;
-    typedef DeqTPtrVec* DeqTPtrVecPtr;
-
-    typedef IgushArray<T, Alloc>* IgushArrayTPtr;
-    typedef const IgushArray<T, Alloc>* IgushArrayTConstPtr;
-    
-    class OneValueIterator {
-    
-    public:
-
-        typedef std::random_access_iterator_tag iterator_category;
-        typedef size_t size_type;
-        typedef ptrdiff_t difference_type;
-        typedef T value_type;
-        typedef T& reference;
-        typedef T* pointer;
-
-        OneValueIterator(int n, const T& value):  _n(n), _value(value) {}
-
-        inline OneValueIterator& operator++()
-            { ++_n; return *this; }
-        inline OneValueIterator operator++(int)
-            { OneValueIterator ovi = *this; ++*this; return ovi; }
-        inline OneValueIterator& operator--()
-            { --_n; return *this; }
-        inline OneValueIterator operator--(int)
-            { OneValueIterator ovi = *this; --*this; return ovi; }
-
-        inline OneValueIterator& operator+=(difference_type incr)
-            { _n += incr; return *this; }
-        inline OneValueIterator operator+(difference_type incr) const
-            { OneValueIterator ovi = *this; ovi += incr; return ovi; }
-        inline OneValueIterator& operator-=(difference_type decr)
-            { _n -= decr; return *this; }
-        inline OneValueIterator operator-(difference_type decr) const
-            { OneValueIterator ovi = *this; ovi -= decr; return ovi; }
-
-        inline difference_type operator-(const OneValueIterator& ovi) const
-            { return _n - ovi._n; }
-
-        inline const T& operator*() const
-            { return _value; }
-        inline const T* operator->() const
-            { return &_value; }
-
-        inline bool operator==(const OneValueIterator& ovi) const
-            { return _n == ovi._n; }
-        inline bool operator!=(const OneValueIterator& ovi) const
-            { return !(*this == ovi); }
-        inline bool operator<(const OneValueIterator& ovi) const
-            { return _n < ovi._n; }
-        inline bool operator<=(const OneValueIterator& ovi) const
-            { return (*this < ovi || *this == ovi); }
-        inline bool operator>(const OneValueIterator& ovi) const
-            { return _n > ovi._n; }
-        inline bool operator>=(const OneValueIterator& ovi) const
-            { return (*this > ovi || *this == ovi); }
-
-    private:
-
-        size_type _n;
-        const T& _value;
-    };
-
-public:
-
-    enum ReserveMode {NO, IF_NEEDED, YES};
-
-    typedef Alloc allocator_type;
-
-    typedef typename Alloc::size_type size_type;
-    typedef typename Alloc::difference_type difference_type;
-    typedef T value_type;
-    typedef const T const_value_type;
-
-    typedef typename Alloc::reference reference;
-    typedef typename Alloc::const_reference const_reference;
-    typedef typename Alloc::pointer pointer;
-    typedef typename Alloc::const_pointer const_pointer;
-
-    template <class U, class IgushArrayPtr, class VecIter, class DeqIter>
-    class IgushArrayIterator {
-
-        typedef IgushArrayIterator<U, IgushArrayPtr, VecIter, DeqIter> Self;
-        typedef IgushArrayIterator<const T, IgushArrayTConstPtr, DeqTPtrVecConstIter, DeqTConstIter> SelfConst;
-
-        IgushArrayIterator(IgushArrayPtr ia, VecIter vec_it, DeqIter deq_it)
-            :_ia(ia), _vec_it(vec_it), _deq_it(deq_it) {}
-    
-    public:
-
-        typedef std::random_access_iterator_tag iterator_category;
-        typedef size_t size_type;
-        typedef ptrdiff_t difference_type;
-        typedef U value_type;
-        typedef U& reference;
-        typedef U* pointer;
-
-        Self& operator++();
-        Self operator++(int);
-        Self& operator--();
-        Self operator--(int);
-
-        Self& operator+=(difference_type);
-        Self operator+(difference_type) const;
-        Self& operator-=(difference_type);
-        Self operator-(difference_type) const;
-
-        difference_type operator-(const Self& iai) const;
-
-        inline U& operator*()
-            { return *_deq_it; }
-        inline U* operator->()
-            { return &(*_deq_it); }
-
-        inline bool operator==(const Self& iai) const
-            { return _vec_it == iai._vec_it && _deq_it == iai._deq_it; }
-        inline bool operator!=(const Self& iai) const
-            { return !(*this == iai); }
-        inline bool operator<(const Self& iai) const
-            { return (_vec_it < iai._vec_it) || (_vec_it == iai._vec_it && _deq_it < iai._deq_it); }
-        inline bool operator<=(const Self& iai) const
-            { return (*this < iai || *this == iai); }
-        inline bool operator>(const Self& iai) const
-            { return (_vec_it > iai._vec_it) || (_vec_it == iai._vec_it && _deq_it > iai._deq_it); }
-        inline bool operator>=(const Self& iai) const
-            { return (*this > iai || *this == iai); }
-
-        inline operator SelfConst()
-            { return SelfConst(_ia, _vec_it, _deq_it); }
-
-    private:
-
-        IgushArrayPtr _ia;
-        VecIter _vec_it;
-        DeqIter _deq_it;
-
-        friend class IgushArray<T, Alloc>;
-    };
-
-    typedef IgushArrayIterator<T, IgushArrayTPtr, DeqTPtrVecIter, DeqTIter> iterator;
-    typedef IgushArrayIterator<const T, IgushArrayTConstPtr, DeqTPtrVecConstIter, DeqTConstIter> const_iterator;
-    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
-    typedef std::reverse_iterator<iterator> reverse_iterator;
-    
-    explicit IgushArray(const Alloc& a = Alloc());
-    explicit IgushArray(size_type n, const T& value = T(), const Alloc& a = Alloc());
-    template <class InputIterator>
-    IgushArray(InputIterator first, InputIterator last, const Alloc& a = Alloc());
-    IgushArray(IgushArray<T, Alloc>& ia);
-    ~IgushArray();
-    void operator=(IgushArray<T, Alloc>& ia) { IgushArray<T, Alloc>(ia).swap(*this); }
-    
-    inline bool empty() const
-        { return (_v->size() == 1 && _v->back()->empty()); }
-    inline size_type size() const
-        { return (_v->size()?((_v->size() - 1)*_deq_size + _v->back()->size()):0); }
-    void resize(size_type n, const T& value = T(), ReserveMode reserve_mode = NO);
-    inline size_type capacity() const
-        { return _capacity; }
-    void reserve(size_type n);
-
-    inline iterator begin()
-        { return iterator(this, _v->begin(), _v->front()->begin()); }
-    inline const_iterator begin() const
-        { return const_iterator(this, _v->begin(), _v->front()->begin()); }
-    inline iterator end()
-        { return iterator(this, _v->end() - 1, _v->back()->end()); }
-    inline const_iterator end() const
-        { return const_iterator(this, _v->end() - 1, _v->back()->end()); }
-
-    inline reverse_iterator rbegin()
-        { return reverse_iterator(end()); }
-    inline const_reverse_iterator rbegin() const
-        { return const_reverse_iterator(end()); }
-    inline reverse_iterator rend()
-        { return reverse_iterator(begin()); }
-    inline const_reverse_iterator rend() const
-        { return const_reverse_iterator(begin()); }
-
-    reference operator[](size_type);
-    const_reference operator[](size_type) const;
-    reference at(size_type);
-    const_reference at(size_type) const;
-
-    inline reference front()
-        { return _v->front()->front(); }
-    inline const_reference front() const
-        { return _v->front()->front(); }
-    inline reference back()
-        { return _v->back()->back(); }
-    inline const_reference back() const
-        { return _v->back()->back(); }
-
-    void assign(size_type n, const T& value, ReserveMode reserve_mode = NO)
-        { assign(OneValueIterator(0, value), OneValueIterator(n, value), reserve_mode); }
-    template <class InputIterator>
-    void assign(InputIterator first, InputIterator last, ReserveMode reserve_mode = NO);
-
-    void push_back(const T&);
-    void pop_back();
-
-    iterator insert(iterator, const T&);
-    iterator insert(iterator it, size_type n, const T& value, ReserveMode reserve_mode = NO)
-        { return insert(it, OneValueIterator(0, value), OneValueIterator(n, value), reserve_mode); }
-    template <class InputIterator>
-    iterator insert(iterator, InputIterator first, InputIterator last, ReserveMode reserve_mode = NO);
-    iterator erase(iterator);
-    iterator erase(iterator, iterator);
-    
-    void swap(IgushArray<T, Alloc>&);
-    void clear();
-    inline Alloc get_allocator()
-        { return _a; }
-
-private:
-
-    void _reserve(size_type n);
-    void _decrease_size(size_type n);
-    void _delete_deques();
-
-    template <class InputIterator>
-    void _push_back(InputIterator first, InputIterator last);
-    template <class InputIterator>
-    void _push_back(InputIterator& first, size_type n);
-
-    template <class InputIterator>
-    iterator _fill(iterator, InputIterator first, InputIterator last);
-    template <class InputIterator>
-    iterator _fill(iterator, InputIterator& first, size_type n);
-
-    size_type _capacity;
-    DeqTPtrVecPtr _v;
-    typename DeqT::size_type _deq_size;
-    typename DeqTPtrVec::size_type _vec_size;
-    Alloc _a;
-};
- 
-template <class T, class Alloc>
-template <class U, class IgushArrayPtr, class VecIter, class DeqIter>
-typename IgushArray<T, Alloc>::template IgushArrayIterator<U, IgushArrayPtr, VecIter, DeqIter>&
-IgushArray<T, Alloc>::IgushArrayIterator<U, IgushArrayPtr, VecIter, DeqIter>::operator+=(difference_type incr)
-{
-    if (!incr)
-        return *this;
-
-    if (incr < 0)
-        return (*this -= (-incr));
-
-    if (incr >= (*_vec_it)->end() - _deq_it && _vec_it != _ia->_v->end()-1) {
-        incr -= ((*_vec_it)->end() - _deq_it);
-        ++_vec_it;
-
-        typename DeqTPtrVec::size_type incr_vec = floor(incr/_ia->_deq_size);
-        if (_vec_it + incr_vec >= _ia->_v->end())
-            incr_vec = _ia->_v->end() - _vec_it - 1;
-
-        incr -= incr_vec * _ia->_deq_size;
-        _vec_it += incr_vec;
-        _deq_it = (*_vec_it)->begin();
-    }
-    
-    _deq_it += incr;
-    return *this;
-}
-
-template <class T, class Alloc>
-template <class U, class IgushArrayPtr, class VecIter, class DeqIter>
-typename IgushArray<T, Alloc>::template IgushArrayIterator<U, IgushArrayPtr, VecIter, DeqIter>
-IgushArray<T, Alloc>::IgushArrayIterator<U, IgushArrayPtr, VecIter, DeqIter>::operator+(difference_type incr) const
-{
-    Self temp = *this;
-    temp += incr;
-    return temp;
-}
-
-template <class T, class Alloc>
-template <class U, class IgushArrayPtr, class VecIter, class DeqIter>
-typename IgushArray<T, Alloc>::template IgushArrayIterator<U, IgushArrayPtr, VecIter, DeqIter>&
-IgushArray<T, Alloc>::IgushArrayIterator<U, IgushArrayPtr, VecIter, DeqIter>::operator-=(difference_type decr)
-{
-    if (!decr)
-        return *this;
-
-    if (decr < 0)
-        return (*this += (-decr));
-
-    if (decr > _deq_it - (*_vec_it)->begin()) {
-        decr -= (_deq_it - (*_vec_it)->begin() + 1);
-        --_vec_it;
-
-        typename DeqTPtrVec::size_type decr_vec = floor(decr/_ia->_deq_size);
-        if (_vec_it - decr_vec < _ia->_v->begin())
-            decr_vec = _vec_it - _ia->_v->begin();
-
-        decr -= decr_vec * _ia->_deq_size;
-        _vec_it -= decr_vec;
-        _deq_it = (*_vec_it)->end() - 1;
-    }
-    
-    _deq_it -= decr;
-    return *this;
-}
-
-template <class T, class Alloc>
-template <class U, class IgushArrayPtr, class VecIter, class DeqIter>
-typename IgushArray<T, Alloc>::template IgushArrayIterator<U, IgushArrayPtr, VecIter, DeqIter>
-IgushArray<T, Alloc>::IgushArrayIterator<U, IgushArrayPtr, VecIter, DeqIter>::operator-(difference_type decr) const
-{
-    Self temp = *this;
-    temp -= decr;
-    return temp;
-}
-
-template <class T, class Alloc>
-template <class U, class IgushArrayPtr, class VecIter, class DeqIter>
-typename IgushArray<T, Alloc>::template IgushArrayIterator<U, IgushArrayPtr, VecIter, DeqIter>&
-IgushArray<T, Alloc>::IgushArrayIterator<U, IgushArrayPtr, VecIter, DeqIter>::operator++()
-{
-    ++_deq_it;
-    if (_deq_it == (*_vec_it)->end() && _vec_it < _ia->_v->end() - 1) {
-        ++_vec_it;
-        _deq_it = (*_vec_it)->begin();
-    }
-    return *this;
-}
-
-template <class T, class Alloc>
-template <class U, class IgushArrayPtr, class VecIter, class DeqIter>
-typename IgushArray<T, Alloc>::template IgushArrayIterator<U, IgushArrayPtr, VecIter, DeqIter>
-IgushArray<T, Alloc>::IgushArrayIterator<U, IgushArrayPtr, VecIter, DeqIter>::operator++(int)
-{
-    Self temp = *this;
-    ++*this;
-    return temp;
-}
-
-template <class T, class Alloc>
-template <class U, class IgushArrayPtr, class VecIter, class DeqIter>
-typename IgushArray<T, Alloc>::template IgushArrayIterator<U, IgushArrayPtr, VecIter, DeqIter>&
-IgushArray<T, Alloc>::IgushArrayIterator<U, IgushArrayPtr, VecIter, DeqIter>::operator--()
-{
-    if (_deq_it == (*_vec_it)->begin() && _vec_it != _ia->_v->begin()) {
-        --_vec_it;
-        _deq_it = (*_vec_it)->end();
-    }
-    --_deq_it;
-
-    return *this;
-}
-
-template <class T, class Alloc>
-template <class U, class IgushArrayPtr, class VecIter, class DeqIter>
-typename IgushArray<T, Alloc>::template IgushArrayIterator<U, IgushArrayPtr, VecIter, DeqIter>
-IgushArray<T, Alloc>::IgushArrayIterator<U, IgushArrayPtr, VecIter, DeqIter>::operator--(int)
-{
-    Self temp = *this;
-    --*this;
-    return temp;
-}
-
-template <class T, class Alloc>
-template <class U, class IgushArrayPtr, class VecIter, class DeqIter>
-typename IgushArray<T, Alloc>::template IgushArrayIterator<U, IgushArrayPtr, VecIter, DeqIter>::difference_type
-IgushArray<T, Alloc>::IgushArrayIterator<U, IgushArrayPtr, VecIter, DeqIter>::operator-(const Self& iai) const
-{
-    if (*this < iai)
-        return -(iai - *this);
-
-    if (_vec_it > iai._vec_it)
-        return (_vec_it - iai._vec_it - 1)*_ia->_deq_size +
-            (_deq_it - (*_vec_it)->begin()) +
-            ((DeqIter)(*iai._vec_it)->end() - iai._deq_it);
-    else
-        return (_deq_it - iai._deq_it);
-}
-
-template <class T, class Alloc>
-IgushArray<T, Alloc>::IgushArray(const Alloc& a)
-: _a(a)
-{
-    _reserve(0);
-}
-
-template <class T, class Alloc>
-IgushArray<T, Alloc>::IgushArray(size_type n, const T& value, const Alloc& a)
-: _a(a)
-{
-    _reserve(n);
-    _push_back(OneValueIterator(0, value), OneValueIterator(n, value));
-}
-
-template <class T, class Alloc>
-template <class InputIterator>
-IgushArray<T, Alloc>::IgushArray(InputIterator first, InputIterator last, const Alloc& a)
-: _a(a)
-{
-    size_type n = data_size(first, last);
-    _reserve(n);
-    _push_back(first, last);
-}
-
-template <class T, class Alloc>
-IgushArray<T, Alloc>::IgushArray(IgushArray<T, Alloc>& ia)
-: _a(ia._a)
-{
-    _reserve(ia.capacity());
-    _push_back(ia.begin(), ia.end());
-}
-
-template <class T, class Alloc>
-IgushArray<T, Alloc>::~IgushArray()
-{
-    _delete_deques();
-    delete _v;
-}
-
-template <class T, class Alloc>
-void IgushArray<T, Alloc>::resize(size_type n, const T& value, ReserveMode reserve_mode)
-{
-    size_type current_size = size();
-
-    if ((n > _capacity && reserve_mode) == IF_NEEDED || reserve_mode == YES) {
-        //we have to recalculate sizes
-
-        IgushArray ia;
-        ia._reserve(n);
-        if (n >= current_size) {     //we have to add new elements
-            ia._push_back(begin(), end());
-            ia._push_back(OneValueIterator(0, value), OneValueIterator(n - current_size, value));
-        }
-        else if (n < current_size) {    //we have to remove spare elements
-            iterator first = begin();
-            ia._push_back(first, n);
-        }
-        swap(ia);
-    }
-    else {
-
-        //we have change the size only
-
-        if (n >= current_size)       //we have to add new elements
-            _push_back(OneValueIterator(0, value), OneValueIterator(n - current_size, value));
-        else if (n < current_size)  //we have to remove spare elements
-            _decrease_size(n);
-    }
-}
-
-
-template <class T, class Alloc>
-void IgushArray<T, Alloc>::reserve(size_type n)
-{
-    if (n <= _capacity)
-        return;
-
-    IgushArray ia;
-    ia._reserve(n);
-    ia._push_back(begin(), end());
-    swap(ia);
-}
-
-template <class T, class Alloc>
-typename IgushArray<T, Alloc>::reference IgushArray<T, Alloc>::operator[](size_type n)
-
-{
-    typename DeqTPtrVec::size_type vec_n = floor(n/_deq_size);
-    DeqTPtr deq_ptr = _v->operator[](vec_n);
-    return deq_ptr->operator[](n-vec_n*_deq_size);
-}
-
-template <class T, class Alloc>
-typename IgushArray<T, Alloc>::const_reference IgushArray<T, Alloc>::operator[](size_type n) const
-{
-    typename DeqTPtrVec::size_type vec_n = floor(n/_deq_size);
-    const DeqTPtr deq_ptr = _v->operator[](vec_n);
-    return deq_ptr->operator[](n-vec_n*_deq_size);
-}
-
-template <class T, class Alloc>
-typename IgushArray<T, Alloc>::reference IgushArray<T, Alloc>::at(size_type n)
-{
-    typename DeqTPtrVec::size_type vec_n = floor(n/_deq_size);
-    DeqTPtr deq_ptr = _v->at(vec_n);
-    return deq_ptr->at(n-vec_n*_deq_size);
-}
-
-template <class T, class Alloc>
-typename IgushArray<T, Alloc>::const_reference IgushArray<T, Alloc>::at(size_type n) const
-{
-    typename DeqTPtrVec::size_type vec_n = floor(n/_deq_size);
-    const DeqTPtr deq_ptr = _v->at(vec_n);
-    return deq_ptr->at(n-vec_n*_deq_size);
-}
-
-template <class T, class Alloc>
-template <class InputIterator>
-void IgushArray<T, Alloc>::assign(InputIterator first, InputIterator last, ReserveMode reserve_mode)
-{
-    size_type current_size = size();
-    size_type n = data_size(first, last);
-
-    if ((n > _capacity && reserve_mode) == IF_NEEDED || reserve_mode == YES) {
-        //we have to recalculate sizes
-
-        IgushArray ia;
-        ia._reserve(n);
-        ia._push_back(first, last);
-        swap(ia);
-    }
-    else {
-        //we have change the size only
-
-        if (n >= current_size) {
-            _fill(begin(), first, current_size);
-            _push_back(first, last);
-        }
-        else if (n < current_size) {
-            _decrease_size(n);
-            _fill(begin(), first, last);
-        }
-    }
-}
-
-template <class T, class Alloc>
-void IgushArray<T, Alloc>::push_back(const T& val)
-{
-    if (_v->back()->size() == _deq_size)
-        #ifdef USE_FIXED_DEQUE
-        _v->push_back(new DeqT(_deq_size, _a));
-        #else
-        _v->push_back(new DeqT(_a));
-        #endif
-    _v->back()->push_back(val);
-}
-
-template <class T, class Alloc>
-void IgushArray<T, Alloc>::pop_back()
-{
-    _v->back()->pop_back();
-    if (_v->back()->empty() && _v->size() > 1) {
-        delete _v->back();
-        _v->back() = 0;
-        _v->pop_back();
-    }
-}
-
-template <class T, class Alloc>
-typename IgushArray<T, Alloc>::iterator IgushArray<T, Alloc>::insert(iterator it, const T& val)
-{
-    size_type result = it-begin();
-    T temp1, temp2;
-
-    //If the iterator points to end
-    if (it._deq_it == (*it._vec_it)->end()) {
-        temp2 = val;
-    }
-    //If the iterator points to last element in the deque
-    else if (it._deq_it == (*it._vec_it)->end()-1) {
-        temp2 = (*it._vec_it)->back();
-        (*it._vec_it)->pop_back();
-        (*it._vec_it)->push_back(val);
-    }
-    //If no, just insert new element to its place
-    else {
-        temp2 = (*it._vec_it)->back();
-        (*it._vec_it)->pop_back();
-        (*it._vec_it)->insert(it._deq_it, val);
-    }
-
-    ++it._vec_it;
-
-    //Move the rest of elements to the end
-    for (DeqTPtrVecIter _vec_it = it._vec_it; _vec_it < _v->end(); ++_vec_it) {
-        temp1 = (*_vec_it)->back();
-        (*_vec_it)->pop_back();
-        (*_vec_it)->push_front(temp2);
-        temp2 = temp1;
-    }
-    
-    push_back(temp2);
-
-    return begin()+result;
-}
-
-template <class T, class Alloc>
-template <class InputIterator>
-typename IgushArray<T, Alloc>::iterator IgushArray<T, Alloc>::insert(iterator it, InputIterator first, InputIterator last, ReserveMode reserve_mode)
-{
-    size_type result = it-begin();
-    std::deque<T> temp1, temp2;
-
-    //Define how many new elements should be inserted
-    size_type n = data_size(first, last);
-
-    //Define total new size
-    size_type total_new_size = size() + n;
-    
-    if ((total_new_size > _capacity && reserve_mode == IF_NEEDED) || reserve_mode == YES) {
-        //we have to recalculate sizes
-
-        IgushArray ia;
-        ia._reserve(total_new_size);
-        ia._push_back(begin(), it);
-        ia._push_back(first, last);
-        ia._push_back(it, end());
-        swap(ia);
-    }
-    else {
-        //Define important values in it queue
-        typename DeqT::size_type size_to_end = (*it._vec_it)->end() - it._deq_it;
-        typename DeqT::size_type empty_to_end = _deq_size - (*it._vec_it)->size();
-        typename DeqT::size_type capacity_to_end = size_to_end + empty_to_end;
-
-        if (n > capacity_to_end) {
-            //Save the end of the current deque by adding them info the temp deque
-            for (size_type i = 0; i < size_to_end; ++i) {
-                temp1.push_front((*it._vec_it)->back());
-                (*it._vec_it)->pop_back();
-            }
-    
-            //And fill this end with the first portion of the new elements
-            for (size_type i = 0; i < capacity_to_end; ++i)
-                (*it._vec_it)->push_back(*first++);
-            n -= capacity_to_end;
-    
-            ++it._vec_it;
-
-            //Define how many new structural deques should to be inserted and insert them
-            typename DeqTPtrVec::size_type insert_vectors = floor(n/_deq_size);
-            typename DeqTPtrVec::size_type cur_vec_pos = it._vec_it-_v->begin();
-            _v->insert(it._vec_it, insert_vectors, 0);
-            it._vec_it = _v->begin() + cur_vec_pos;
-
-            //Fill new deques
-            for (typename DeqTPtrVec::size_type vec_i = 0; vec_i < insert_vectors; ++vec_i) {
-                #ifdef USE_FIXED_DEQUE
-                (*it._vec_it) = new DeqT(_deq_size, _a);
-                #else
-                (*it._vec_it) = new DeqT(_a);
-                #endif
-                for (size_type i = 0; i < _deq_size; ++i)
-                    (*it._vec_it)->push_back(*first++);
-                ++it._vec_it;
-                n -= _deq_size;
-            }
-
-            //Just add rest of the new elements to the deque
-            for (size_type i = 0; i < n; ++i)
-                temp1.push_front(*--last);
-        }
-        else {
-            //Save the end of the current deque by adding them info the temp deque
-            if (n > empty_to_end)
-                for (size_type i = 0; i < n - empty_to_end; ++i) {
-                    temp1.push_front((*it._vec_it)->back());
-                    (*it._vec_it)->pop_back();
-                }
-
-            //Insert the new elements
-            (*it._vec_it)->insert(it._deq_it, first, last);
-    
-            ++it._vec_it;
-        }
-
-        size_type move = temp1.size();
-
-        //If the temp deque there are more elements than the structural deque size, just insert the new one
-        if (move >= _deq_size) {
-            #ifdef USE_FIXED_DEQUE
-            it._vec_it = _v->insert(it._vec_it, new DeqT(_deq_size, _a));
-            #else
-            it._vec_it = _v->insert(it._vec_it, new DeqT(_a));
-            #endif
-            for (size_type i = 0; i < _deq_size; ++i) {
-                (*it._vec_it)->push_back(temp1.front());
-                temp1.pop_front(); 
-            }
-            ++it._vec_it;
-            move -= _deq_size;
-        }
-
-        //Move the rest of elements to the end
-        //Same logic as for one element
-        for (DeqTPtrVecIter _vec_it = it._vec_it; _vec_it != _v->end(); ++_vec_it) {
-            for (size_type i = 0; i < move && (*_vec_it)->size(); ++i) {
-                temp2.push_front((*_vec_it)->back());
-                (*_vec_it)->pop_back();
-            }
-            for (size_type i = 0; i < move; ++i) {
-                (*_vec_it)->push_front(temp1.back());
-                temp1.pop_back();
-            }
-            temp2.swap(temp1);
-        }
-   
-        _push_back(temp1.begin(), temp1.end());
-    }
-    return begin()+result;
-}
-
-template <class T, class Alloc>
-typename IgushArray<T, Alloc>::iterator IgushArray<T, Alloc>::erase(iterator it)
-{
-    size_type result = it-begin();
-    T temp1, temp2;
-
-    //Move one element up
-    for (DeqTPtrVecIter _vec_it = _v->end() - 1; _vec_it >= it._vec_it; --_vec_it) {
-        temp1 = (*_vec_it)->front();
-        if (_vec_it == it._vec_it)
-            (*_vec_it)->erase(it._deq_it);
-        else
-            (*_vec_it)->pop_front();
-        if (_vec_it != _v->end() - 1)
-            (*_vec_it)->push_back(temp2);
-        temp2 = temp1;
-    }
-
-    //Check last queue if it's empty
-    if (_v->back()->empty() && _v->size() > 1) {
-        delete _v->back();
-        _v->back() = 0;
-        _v->pop_back();
-    }
-
-    return begin()+result;
-}
-
-template <class T, class Alloc>
-typename IgushArray<T, Alloc>::iterator IgushArray<T, Alloc>::erase(iterator it_first, iterator it_last)
-{
-    if (it_first >= it_last)
-        return it_first;
-
-    size_type result = it_first-begin();
-    std::deque<T> temp1, temp2;
-
-    //Define how many new elements should be erased and how many after erased
-    size_type n = it_last - it_first;
-    typename DeqTPtrVec::size_type erase_vectors = floor(n/_deq_size);
-    size_type erase_elements = n - erase_vectors*_deq_size;
-    size_type total_to_end = end() - it_last;
-    size_type move = (erase_elements<total_to_end)?erase_elements:total_to_end;
-
-    if (it_last._deq_it == (*it_last._vec_it)->begin()){
-        --it_last._vec_it;
-        it_last._deq_it = (*it_last._vec_it)->end();
-    }
-
-    //Move some elements up
-    DeqTPtrVecIter _vec_it = _v->end() - 1;
-    for (;_vec_it > it_last._vec_it; --_vec_it) {
-        for (size_type i = 0; i < move && (*_vec_it)->size(); ++i) {
-            temp2.push_back((*_vec_it)->front());
-            (*_vec_it)->pop_front();
-        }
-        for (size_type i = 0; i < move && temp1.size(); ++i) {
-            (*_vec_it)->push_back(temp1.front());
-            temp1.pop_front();
-        }
-        if ((*_vec_it)->empty() && _v->size() > 1) {
-            delete *_vec_it;
-            *_vec_it = 0;
-            _vec_it = _v->erase(_vec_it);
-        }
-        temp2.swap(temp1);
-    }
-
-    //Save the rest of elements in the last erased queue
-    for (DeqTIter deq_it = (*it_last._vec_it)->end(); deq_it-- != it_last._deq_it;)
-        temp1.push_front(*deq_it);
-
-    //Save the rest of elements in the first erased queue
-    for (DeqTIter deq_it = it_first._deq_it; deq_it-- != (*it_first._vec_it)->begin();)
-        temp1.push_front(*deq_it);
-
-    //Define erased deques
-    typename DeqTPtrVec::size_type to_safe = ceil((double)temp1.size()/_deq_size);
-    DeqTPtrVecIter first_to_be_erased = it_first._vec_it + to_safe;
-    DeqTPtrVecIter last_to_be_erased = it_last._vec_it + 1;
-    typename DeqTPtrVec::size_type to_delete = last_to_be_erased - first_to_be_erased;
-    bool all_vectors = (to_delete >= _v->size());
-    for (DeqTPtrVecIter to_be_erased = first_to_be_erased; to_be_erased != last_to_be_erased; ++to_be_erased) {
-        if (to_be_erased == first_to_be_erased && all_vectors)
-            (*to_be_erased)->clear();
-        else
-            delete *to_be_erased;
-    }
-
-    //Erase deques
-    if (last_to_be_erased - (first_to_be_erased + all_vectors) > 0)
-        _vec_it = _v->erase(first_to_be_erased + all_vectors, last_to_be_erased);
-    else
-        _vec_it = first_to_be_erased;
-    _vec_it -= to_safe;
-
-    //Put elements that have been moved up
-    if (temp1.size()) {
-        (*_vec_it)->clear();
-        while (temp1.size()) {
-            (*_vec_it)->push_back(temp1.front());
-            temp1.pop_front();
-            if ((*_vec_it)->size() == _deq_size && temp1.size()) {
-                ++_vec_it;
-                (*_vec_it)->clear();
-            }
-        }
-    }
-
-    return begin()+result;
-}
-
-template <class T, class Alloc>
-void IgushArray<T, Alloc>::swap(IgushArray<T, Alloc>& ia)
-{
-    std::swap(_capacity, ia._capacity);
-    std::swap(_v, ia._v);
-    std::swap(_deq_size, ia._deq_size);
-    std::swap(_vec_size, ia._vec_size);
-    std::swap(_a, ia._a);
-}
-
-template <class T, class Alloc>
-void IgushArray<T, Alloc>::clear()
-{
-    _delete_deques();
-    _v->resize(0);
-}
-
-template <class T, class Alloc>
-void IgushArray<T, Alloc>::_reserve(size_type n)
-{
-    //Calculate sizes
-    _deq_size = (typename DeqT::size_type) sqrt((double)n);
-    if (!_deq_size)
-        _deq_size = 1;
-    _vec_size = (typename DeqTPtrVec::size_type) ceil((double)n/_deq_size);
-    if (!_vec_size)
-        _vec_size = 1;
-    _capacity = _vec_size*_deq_size;
-
-    //Create vector, reserve and create first empty deque for "end" element
-    _v = new DeqTPtrVec();
-    _v->reserve(_vec_size);
-    #ifdef USE_FIXED_DEQUE
-    _v->push_back(new DeqT(_deq_size, _a));
-    #else
-    _v->push_back(new DeqT(_a));
-    #endif
-}
-
-template <class T, class Alloc>
-void IgushArray<T, Alloc>::_decrease_size(size_type n)
-{
-    typename DeqTPtrVec::size_type vec_size = (typename DeqTPtrVec::size_type) ceil((double)n/_deq_size);
-    if (!vec_size)
-        vec_size = 1;
-    for (DeqTPtrVecIter _v_it = _v->begin()+vec_size; _v_it != _v->end(); ++_v_it)
-        delete *_v_it;
-
-    _v->resize(vec_size);
-    _v->back()->resize( n - (_v->size()-1)*_deq_size );
-}
-
-template <class T, class Alloc>
-void IgushArray<T, Alloc>::_delete_deques()
-{
-    for (DeqTPtrVecIter _v_it = _v->begin(); _v_it != _v->end(); ++_v_it)
-        delete *_v_it;
-}
-
-template <class T, class Alloc>
-template <class InputIterator>
-void IgushArray<T, Alloc>::_push_back(InputIterator first, InputIterator last)
-{
-    while (first != last)
-        push_back(*first++);
-}
-
-template <class T, class Alloc>
-template <class InputIterator>
-void IgushArray<T, Alloc>::_push_back(InputIterator& first, size_type n)
-{
-    for (size_type i = 0; i < n; ++i)
-        push_back(*first++);
-}
-
-template <class T, class Alloc>
-template <class InputIterator>
-typename IgushArray<T, Alloc>::iterator IgushArray<T, Alloc>::_fill(iterator where, InputIterator first, InputIterator last)
-{
-    while (first != last)
-        *where++ = *first++;
-    return where;
-}
-
-template <class T, class Alloc>
-template <class InputIterator>
-typename IgushArray<T, Alloc>::iterator IgushArray<T, Alloc>::_fill(iterator where, InputIterator& first, size_type n)
-{
-    for (size_type i = 0; i < n; ++i)
-        *where++ = *first++;
-    return where;
-}
-
-#endif
+/**
+    @author Eduard Igushev visit <www.igushev.com> e-mail <eduard@igushev.com>
+    @brief Stability test pack for fixed deque
+
+    The IgushArray class totally implements std::vector interface.
+    IgushArray class totally provides iterator mechanism,
+    but this mechanism does not guarantee an iterator consistence after modifying operations
+    such as insert/erase, push back/pop back and so on.
+
+    The deques are stored by value in one contiguous directory owned by IgushArray,
+    so an access by number loads the deque metadata and then the element itself.
+    The deque storage is given to the deques by IgushArray: from the allocator or from the arena,
+    whose slabs may be mapped in huge pages.
+
+    Warranty and license
+    The implementation is provided “as it is” with no warranty.
+    Any private and commercial usage is allowed.
+    Keeping the original name and link to the source is required.
+    Any feedback is welcomed :-)
+*/
+
+#ifndef _IgushArray_h
+#define _IgushArray_h
+
+#include <vector>
+#include "fixed_deque.h"
+#include "block_arena.h"
+#include "block_counts.h"
+#include "segment_kernels.h"
+#include <iterator>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <stdexcept>
+#include <new>
+#include <cassert>
+#include <math.h>
+#include "size_helper.h"
+#include "alloc_helper.h"
+
+template <class T, class Alloc = std::allocator<T> >
+class IgushArray {
+
+    typedef std::allocator_traits<Alloc> AllocTraits;
+    typedef FixedDeque<T, Alloc> DeqT;
+    typedef typename DeqT::iterator DeqTIter;
+    typedef typename DeqT::const_iterator DeqTConstIter;
+    typedef typename AllocTraits::template rebind_alloc<DeqT> DeqTAlloc;
+
+    typedef std::vector<DeqT, DeqTAlloc> DeqTVec;
+    typedef typename DeqTVec::iterator DeqTVecIter;
+    typedef typename DeqTVec::const_iterator DeqTVecConstIter;
+
+    typedef IgushArray<T, Alloc>* IgushArrayTPtr;
+    typedef const IgushArray<T, Alloc>* IgushArrayTConstPtr;
+    
+    class OneValueIterator {
+    
+    public:
+
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+        typedef T value_type;
+        typedef T& reference;
+        typedef T* pointer;
+
+        OneValueIterator(int n, const T& value):  _n(n), _value(value) {}
+
+        inline OneValueIterator& operator++()
+            { ++_n; return *this; }
+        inline OneValueIterator operator++(int)
+            { OneValueIterator ovi = *this; ++*this; return ovi; }
+        inline OneValueIterator& operator--()
+            { --_n; return *this; }
+        inline OneValueIterator operator--(int)
+            { OneValueIterator ovi = *this; --*this; return ovi; }
+
+        inline OneValueIterator& operator+=(difference_type incr)
+            { _n += incr; return *this; }
+        inline OneValueIterator operator+(difference_type incr) const
+            { OneValueIterator ovi = *this; ovi += incr; return ovi; }
+        inline OneValueIterator& operator-=(difference_type decr)
+            { _n -= decr; return *this; }
+        inline OneValueIterator operator-(difference_type decr) const
+            { OneValueIterator ovi = *this; ovi -= decr; return ovi; }
+
+        inline difference_type operator-(const OneValueIterator& ovi) const
+            { return _n - ovi._n; }
+
+        inline const T& operator*() const
+            { return _value; }
+        inline const T* operator->() const
+            { return &_value; }
+
+        inline bool operator==(const OneValueIterator& ovi) const
+            { return _n == ovi._n; }
+        inline bool operator!=(const OneValueIterator& ovi) const
+            { return !(*this == ovi); }
+        inline bool operator<(const OneValueIterator& ovi) const
+            { return _n < ovi._n; }
+        inline bool operator<=(const OneValueIterator& ovi) const
+            { return (*this < ovi || *this == ovi); }
+        inline bool operator>(const OneValueIterator& ovi) const
+            { return _n > ovi._n; }
+        inline bool operator>=(const OneValueIterator& ovi) const
+            { return (*this > ovi || *this == ovi); }
+
+    private:
+
+        size_type _n;
+        const T& _value;
+    };
+
+public:
+
+    enum ReserveMode {NO, IF_NEEDED, YES};
+    enum StorageMode {HEAP, ARENA, HUGE_PAGES};
+    enum SizingMode {EXACT, POW2};
+    enum GrowthMode {FIXED, GEOMETRIC};
+    enum BlockMode {FULL, SLACK, FENWICK};
+
+    typedef Alloc allocator_type;
+
+    typedef typename AllocTraits::size_type size_type;
+    typedef typename AllocTraits::difference_type difference_type;
+    typedef T value_type;
+    typedef const T const_value_type;
+
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef typename AllocTraits::pointer pointer;
+    typedef typename AllocTraits::const_pointer const_pointer;
+
+    template <class U, class IgushArrayPtr, class VecIter, class DeqIter>
+    class IgushArrayIterator {
+
+        typedef IgushArrayIterator<U, IgushArrayPtr, VecIter, DeqIter> Self;
+        typedef IgushArrayIterator<const T, IgushArrayTConstPtr, DeqTVecConstIter, DeqTConstIter> SelfConst;
+
+        IgushArrayIterator(IgushArrayPtr ia, VecIter vec_it, DeqIter deq_it)
+            :_ia(ia), _vec_it(vec_it), _deq_it(deq_it),
+            _n(ia->_before(vec_it - ia->_v.begin()) + (deq_it - vec_it->begin())) { _cache(); }
+        IgushArrayIterator(IgushArrayPtr ia, VecIter vec_it, DeqIter deq_it, size_t n)
+            :_ia(ia), _vec_it(vec_it), _deq_it(deq_it), _n(n) { _cache(); }
+        IgushArrayIterator(IgushArrayPtr ia, VecIter vec_it, DeqIter deq_it, size_t n, U* first, U* p, U* last)
+            :_ia(ia), _vec_it(vec_it), _deq_it(deq_it), _n(n), _first(first), _p(p), _last(last) {}
+    
+    public:
+
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+        typedef U value_type;
+        typedef U& reference;
+        typedef U* pointer;
+
+        IgushArrayIterator()
+            :_ia(0), _n(0), _first(0), _p(0), _last(0) {}
+
+        //Inside a contiguous piece of a DEQ the iterator moves as a pointer
+        inline Self& operator++()
+            { ++_n; ++_deq_it; if (++_p == _last) _next(); return *this; }
+        inline Self operator++(int)
+            { Self temp = *this; ++*this; return temp; }
+        inline Self& operator--()
+            { --_n; if (_p != _first) { --_p; --_deq_it; } else _prev(); return *this; }
+        inline Self operator--(int)
+            { Self temp = *this; --*this; return temp; }
+
+        Self& operator+=(difference_type);
+        inline Self operator+(difference_type incr) const
+            { Self temp = *this; temp += incr; return temp; }
+        inline Self& operator-=(difference_type decr)
+            { return (*this += -decr); }
+        inline Self operator-(difference_type decr) const
+            { Self temp = *this; temp += -decr; return temp; }
+
+        inline difference_type operator-(const Self& iai) const
+            { return (difference_type)_n - (difference_type)iai._n; }
+
+        inline U& operator*() const
+            { return *_p; }
+        inline U* operator->() const
+            { return _p; }
+        inline U& operator[](difference_type n) const
+            { return *(*this + n); }
+        friend inline Self operator+(difference_type n, const Self& it)
+            { return it + n; }
+
+        inline bool operator==(const Self& iai) const
+            { return _n == iai._n; }
+        inline bool operator!=(const Self& iai) const
+            { return _n != iai._n; }
+        inline bool operator<(const Self& iai) const
+            { return _n < iai._n; }
+        inline bool operator<=(const Self& iai) const
+            { return _n <= iai._n; }
+        inline bool operator>(const Self& iai) const
+            { return _n > iai._n; }
+        inline bool operator>=(const Self& iai) const
+            { return _n >= iai._n; }
+
+        inline operator SelfConst() const
+            { return SelfConst(_ia, _vec_it, _deq_it, _n, _first, _p, _last); }
+
+    private:
+
+        IgushArrayPtr _ia;
+        VecIter _vec_it;
+        DeqIter _deq_it;
+        //The number in the array and the piece of the DEQ with the element
+        size_type _n;
+        U* _first;
+        U* _p;
+        U* _last;
+
+        inline void _cache()
+            { _vec_it->_piece(_deq_it - _vec_it->begin(), _first, _p, _last); }
+        void _next();
+        void _prev();
+        void _seek(size_type n);
+
+        template <class, class, class, class> friend class IgushArrayIterator;
+        friend class IgushArray<T, Alloc>;
+    };
+
+    typedef IgushArrayIterator<T, IgushArrayTPtr, DeqTVecIter, DeqTIter> iterator;
+    typedef IgushArrayIterator<const T, IgushArrayTConstPtr, DeqTVecConstIter, DeqTConstIter> const_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+
+    //An insertion of the value before the element or an erasure of the element,
+    //the element is numbered in the array before the edits.
+    //Only an insertion has the value, so T is not created to erase,
+    //the kind is not to be changed after the edit is constructed
+    struct Edit {
+        enum Kind {INSERT, ERASE};
+        Kind kind;
+        size_type pos;
+        union {
+            T value;
+        };
+
+        Edit(Kind kind, size_type pos)
+            :kind(kind), pos(pos)
+            { if (kind == INSERT) throw std::invalid_argument("Edit(): The insertion has no value"); }
+        Edit(Kind kind, size_type pos, const T& val)
+            :kind(kind), pos(pos) { if (kind == INSERT) new (&value) T(val); }
+        Edit(Kind kind, size_type pos, T&& val)
+            :kind(kind), pos(pos) { if (kind == INSERT) new (&value) T(std::move(val)); }
+        Edit(const Edit& e)
+            :kind(e.kind), pos(e.pos) { if (kind == INSERT) new (&value) T(e.value); }
+        Edit(Edit&& e)
+            :kind(e.kind), pos(e.pos) { if (kind == INSERT) new (&value) T(std::move(e.value)); }
+        ~Edit()
+            { if (kind == INSERT) value.~T(); }
+        Edit& operator=(const Edit& e)
+            { if (this != &e) _assign(e, e.value); return *this; }
+        Edit& operator=(Edit&& e)
+            { if (this != &e) _assign(e, std::move(e.value)); return *this; }
+
+    private:
+
+        template <class V>
+        void _assign(const Edit& e, V&& val);
+    };
+
+    //Collects insertions and erasures at one place and applies them to the array at once.
+    //Until the cursor is flushed size(), empty(), operator[] and at() of the array see the edits
+    //through the cursor, iterators, front/back and changes of the array are asserted against.
+    //The destructor flushes the cursor, std::terminate is called if the flush throws
+    class Cursor {
+
+        Cursor(IgushArrayTPtr ia, size_type pos)
+            :_ia(ia), _pos(pos), _erased(0), _gap(ia->_a) {}
+
+    public:
+
+        Cursor(Cursor&& c);
+        Cursor(const Cursor&) = delete;
+        Cursor& operator=(const Cursor&) = delete;
+        ~Cursor();
+
+        inline size_type position() const
+            { return _pos + _gap.size(); }
+        inline size_type size() const
+            { return _ia->_size() + _gap.size() - _erased; }
+        inline const_reference operator[](size_type n) const
+            { return const_cast<Cursor*>(this)->_element(n); }
+
+        inline void insert(const T& value)
+            { _hold(); _gap.push_back(value); }
+        inline void insert(T&& value)
+            { _hold(); _gap.push_back(std::move(value)); }
+        void erase();
+        void erase_before();
+        void seek(size_type pos);
+        void flush();
+
+    private:
+
+        reference _element(size_type n);
+        void _hold();
+
+        IgushArrayTPtr _ia;
+        //The gap is before the element of the array, the erased elements follow it
+        size_type _pos;
+        size_type _erased;
+        std::vector<T, Alloc> _gap;
+
+        friend class IgushArray<T, Alloc>;
+    };
+    
+    explicit IgushArray(const Alloc& a = Alloc());
+    explicit IgushArray(size_type n, const T& value = T(), const Alloc& a = Alloc());
+    template <class InputIterator>
+    IgushArray(InputIterator first, InputIterator last, const Alloc& a = Alloc());
+    IgushArray(const IgushArray<T, Alloc>& ia)
+        : IgushArray(ia, AllocTraits::select_on_container_copy_construction(ia._a)) {}
+    IgushArray(const IgushArray<T, Alloc>& ia, const Alloc& a);
+    IgushArray(IgushArray<T, Alloc>&& ia) noexcept;
+    ~IgushArray();
+    IgushArray<T, Alloc>& operator=(const IgushArray<T, Alloc>& ia);
+    IgushArray<T, Alloc>& operator=(IgushArray<T, Alloc>&& ia)
+        noexcept(AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value);
+    
+    inline bool empty() const
+        { return _pending?!_pending->size():(_v.empty() || (_v.size() == 1 && _v.back().empty())); }
+    inline size_type size() const
+        { return _pending?_pending->size():_size(); }
+    void resize(size_type n, const T& value = T(), ReserveMode reserve_mode = NO);
+    inline size_type capacity() const
+        { return _capacity; }
+    void reserve(size_type n);
+
+    //The array with no structure yet has both ends before the directory
+    inline iterator begin()
+        { assert(!_pending); return _v.empty()?iterator(this, _v.begin(), DeqTIter(), 0, 0, 0, 0):
+            iterator(this, _v.begin(), _v.front().begin(), 0); }
+    inline const_iterator begin() const
+        { assert(!_pending); return _v.empty()?const_iterator(this, _v.begin(), DeqTConstIter(), 0, 0, 0, 0):
+            const_iterator(this, _v.begin(), _v.front().begin(), 0); }
+    inline iterator end()
+        { assert(!_pending); return _v.empty()?begin():iterator(this, _v.end() - 1, _v.back().end(), size()); }
+    inline const_iterator end() const
+        { assert(!_pending); return _v.empty()?begin():const_iterator(this, _v.end() - 1, _v.back().end(), size()); }
+
+    inline reverse_iterator rbegin()
+        { return reverse_iterator(end()); }
+    inline const_reverse_iterator rbegin() const
+        { return const_reverse_iterator(end()); }
+    inline reverse_iterator rend()
+        { return reverse_iterator(begin()); }
+    inline const_reverse_iterator rend() const
+        { return const_reverse_iterator(begin()); }
+
+    inline reference operator[](size_type n)
+        { return _pending?_pending->_element(n):_element(n); }
+    inline const_reference operator[](size_type n) const
+        { return _pending?_pending->_element(n):_element(n); }
+    reference at(size_type);
+    const_reference at(size_type) const;
+
+    inline reference front()
+        { assert(!_pending); return _v.front().front(); }
+    inline const_reference front() const
+        { assert(!_pending); return _v.front().front(); }
+    inline reference back()
+        { assert(!_pending); return _v.back().back(); }
+    inline const_reference back() const
+        { assert(!_pending); return _v.back().back(); }
+
+    void assign(size_type n, const T& value, ReserveMode reserve_mode = NO)
+        { assign(OneValueIterator(0, value), OneValueIterator(n, value), reserve_mode); }
+    template <class InputIterator>
+    void assign(InputIterator first, InputIterator last, ReserveMode reserve_mode = NO);
+
+    inline void push_back(const T& val)
+        { emplace_back(val); }
+    inline void push_back(T&& val)
+        { emplace_back(std::move(val)); }
+    template <class... Args>
+    void emplace_back(Args&&... args);
+    void pop_back();
+
+    inline iterator insert(iterator it, const T& val)
+        { return emplace(it, val); }
+    inline iterator insert(iterator it, T&& val)
+        { return emplace(it, std::move(val)); }
+    template <class... Args>
+    iterator emplace(iterator, Args&&... args);
+    iterator insert(iterator it, size_type n, const T& value, ReserveMode reserve_mode = NO)
+        { return insert(it, OneValueIterator(0, value), OneValueIterator(n, value), reserve_mode); }
+    template <class InputIterator>
+    iterator insert(iterator, InputIterator first, InputIterator last, ReserveMode reserve_mode = NO);
+    iterator erase(iterator);
+    iterator erase(iterator, iterator);
+    template <class ForwardIterator>
+    void apply_edits(ForwardIterator first, ForwardIterator last);
+    //While the cursor has edits the array is read by size(), operator[] and at()
+    //and must not be changed but through the cursor
+    Cursor cursor(size_type pos);
+    
+    void swap(IgushArray<T, Alloc>&);
+    void clear();
+    inline Alloc get_allocator()
+        { return _a; }
+
+    inline StorageMode storage_mode() const
+        { return _storage_mode; }
+    void storage_mode(StorageMode storage_mode);
+    inline SizingMode sizing_mode() const
+        { return _sizing_mode; }
+    void sizing_mode(SizingMode sizing_mode);
+    inline GrowthMode growth_mode() const
+        { return _growth_mode; }
+    inline void growth_mode(GrowthMode growth_mode)
+        { _growth_mode = growth_mode; }
+    inline BlockMode block_mode() const
+        { return _block_mode; }
+    void block_mode(BlockMode block_mode);
+    //Range insert and erase shift the next deques on this number of threads
+    inline unsigned cascade_threads() const
+        { return _cascade_threads; }
+    inline void cascade_threads(unsigned cascade_threads)
+        { _cascade_threads = cascade_threads?cascade_threads:1; }
+    size_type memory_overhead() const;
+
+    template <class Function>
+    inline Function for_each_segment(Function f)
+        { return for_each_segment(begin(), end(), f); }
+    template <class Function>
+    inline Function for_each_segment(Function f) const
+        { return for_each_segment(begin(), end(), f); }
+    template <class Function>
+    Function for_each_segment(iterator first, iterator last, Function f);
+    template <class Function>
+    Function for_each_segment(const_iterator first, const_iterator last, Function f) const;
+
+    inline iterator find(const T& value)
+        { return _position<iterator>(this, _find(value)); }
+    inline const_iterator find(const T& value) const
+        { return _position<const_iterator>(this, _find(value)); }
+    size_type count(const T& value) const;
+    inline iterator min_element()
+        { return _position<iterator>(this, _extreme(false)); }
+    inline const_iterator min_element() const
+        { return _position<const_iterator>(this, _extreme(false)); }
+    inline iterator max_element()
+        { return _position<iterator>(this, _extreme(true)); }
+    inline const_iterator max_element() const
+        { return _position<const_iterator>(this, _extreme(true)); }
+    template <class U>
+    U accumulate(U init) const;
+
+    template <class Predicate>
+    inline size_type erase_if(Predicate pred)
+        { return _compact([&pred](const T& elem, const T*) { return pred(elem); }); }
+    inline size_type unique()
+        { return unique(std::equal_to<T>()); }
+    template <class BinaryPredicate>
+    inline size_type unique(BinaryPredicate pred)
+        { return _compact([&pred](const T& elem, const T* kept) { return kept && pred(*kept, elem); }); }
+
+    template <class UnaryFunction>
+    void parallel_for_each(UnaryFunction f, unsigned threads = 0);
+    template <class U, class BinaryOperation>
+    U parallel_reduce(U init, BinaryOperation op, unsigned threads = 0) const;
+    template <class U, class AllocU, class UnaryOperation>
+    void parallel_transform(IgushArray<U, AllocU>& out, UnaryOperation op, unsigned threads = 0) const;
+    template <class BinaryOperation>
+    void parallel_inclusive_scan(BinaryOperation op, unsigned threads = 0);
+    template <class BinaryOperation>
+    void parallel_exclusive_scan(const T& init, BinaryOperation op, unsigned threads = 0);
+
+private:
+
+    void _reserve(size_type n);
+    void _reset();
+    inline size_type _before(typename DeqTVec::size_type vec_n) const
+        { return (_block_mode != FULL)?_counts.before(vec_n):vec_n*_deq_size; }
+    //The number of the DEQ and the number in it, the end is the number of the DEQs and 0
+    typedef std::pair<typename DeqTVec::size_type, size_type> Position;
+    template <class Iter, class IgushArrayPtr>
+    static inline Iter _position(IgushArrayPtr ia, const Position& pos)
+        { return (pos.first < ia->_v.size())?Iter(ia, ia->_v.begin() + pos.first, ia->_v[pos.first].begin() + pos.second):
+            Iter(ia->end()); }
+    Position _find(const T& value) const;
+    //The size and the elements without the edits of a cursor
+    inline size_type _size() const
+        { return (_block_mode != FULL)?_counts.total():
+            (_v.size()?((_v.size() - 1)*_deq_size + _v.back().size()):0); }
+    reference _element(size_type);
+    const_reference _element(size_type) const;
+    template <class Remove>
+    size_type _compact(Remove remove);
+    void _replace(size_type pos, size_type n, std::vector<T, Alloc>& values);
+    Position _extreme(bool max) const;
+    template <class BlockFunction>
+    void _parallel_blocks(BlockFunction f, unsigned threads) const;
+    template <class BinaryOperation>
+    std::vector<T, Alloc> _block_totals(BinaryOperation& op, unsigned threads) const;
+    inline size_type _vec_n(size_type n) const
+        { return (_sizing_mode == POW2)?(n >> _deq_shift):(n/_deq_size); }
+    //The structure is re-blocked when the size passes four squared DEQ sizes
+    inline bool _grow_needed(size_type n) const
+        { return _growth_mode == GEOMETRIC && n > 4*_deq_size*_deq_size; }
+    //and back when it falls below a quarter of the squared DEQ size
+    inline bool _shrink_needed(size_type n) const
+        { return _growth_mode == GEOMETRIC && _deq_size > 1 && 4*n < _deq_size*_deq_size; }
+    void _reserve_like(const IgushArray<T, Alloc>& ia, size_type n);
+    void _clone(const IgushArray<T, Alloc>& ia);
+    void _carry_front(typename DeqTVec::size_type vec_n, DeqT& carry);
+    void _pull_front(DeqT& deq, DeqT& next, size_type n);
+    unsigned _cascade_chunks(typename DeqTVec::size_type vec_count, size_type move) const;
+    void _carry_front(typename DeqTVec::size_type vec_n, typename DeqTVec::size_type vec_end, DeqT& carry, unsigned chunks);
+    void _turn_front(typename DeqTVec::size_type vec_n, typename DeqTVec::size_type vec_end, DeqT& carry);
+    void _pull_front(typename DeqTVec::size_type vec_n, typename DeqTVec::size_type vec_end, size_type move, unsigned chunks);
+    void _pull_front(typename DeqTVec::size_type vec_n, typename DeqTVec::size_type vec_end, size_type move, DeqT* next);
+
+    //A slack block is at least half full unless it is the last one
+    inline size_type _min_fill() const
+        { return (_deq_size + 1)/2; }
+    template <class... Args>
+    iterator _slack_emplace(iterator, Args&&... args);
+    template <class InputIterator>
+    void _slack_insert(iterator, InputIterator first, InputIterator last, size_type n);
+    void _slack_erase(iterator, iterator);
+    void _split_insert(typename DeqTVec::size_type vec_n, size_type n, T&& val);
+    void _fix(typename DeqTVec::size_type vec_n);
+    void _rebalance(typename DeqTVec::size_type vec_n);
+    void _destroy();
+    void _decrease_size(size_type n);
+    DeqT _new_deque();
+    void _delete_deque(DeqT&);
+    void _delete_deques();
+
+    template <class InputIterator>
+    void _push_back(InputIterator first, InputIterator last);
+    template <class InputIterator>
+    void _push_back(InputIterator first, InputIterator last, std::random_access_iterator_tag);
+    template <class InputIterator>
+    void _push_back(InputIterator first, InputIterator last, std::input_iterator_tag);
+    template <class InputIterator>
+    void _push_back(InputIterator& first, size_type n);
+
+    template <class InputIterator>
+    iterator _fill(iterator, InputIterator first, InputIterator last);
+    template <class InputIterator>
+    iterator _fill(iterator, InputIterator& first, size_type n);
+
+    size_type _capacity;
+    DeqTVec _v;
+    typename DeqT::size_type _deq_size;
+    typename DeqTVec::size_type _vec_size;
+    StorageMode _storage_mode;
+    SizingMode _sizing_mode;
+    GrowthMode _growth_mode;
+    BlockMode _block_mode;
+    unsigned _cascade_threads;
+    BlockCounts<Alloc> _counts;
+    unsigned _deq_shift;
+    typename DeqT::size_type _deq_mask;
+    BlockArena<T, Alloc> _arena;
+    Alloc _a;
+    //The cursor whose edits are not applied yet
+    Cursor* _pending;
+
+    //A thread is started only if it moves at least this number of elements
+    static const size_type _thread_moves = 32768;
+
+    template <class, class, class> friend class SortedIgushArray;
+};
+ 
+template <class T, class Alloc>
+template <class U, class IgushArrayPtr, class VecIter, class DeqIter>
+typename IgushArray<T, Alloc>::template IgushArrayIterator<U, IgushArrayPtr, VecIter, DeqIter>&
+IgushArray<T, Alloc>::IgushArrayIterator<U, IgushArrayPtr, VecIter, DeqIter>::operator+=(difference_type incr)
+{
+    if (incr >= _first - _p && incr < _last - _p) {
+        _p += incr;
+        _deq_it += incr;
+        _n += incr;
+        return *this;
+    }
+    if (!incr)
+        return *this;
+    difference_type offset = (_deq_it - _vec_it->begin()) + incr;
+    if (offset >= 0 && offset < (difference_type)_vec_it->size()) {
+        _deq_it += incr;
+        _n += incr;
+        _cache();
+        return *this;
+    }
+    _seek(_n + incr);
+    return *this;
+}
+
+/**
+    Moves to the next piece of the DEQ or to the next DEQ, the end stays in the last one.
+*/
+template <class T, class Alloc>
+template <class U, class IgushArrayPtr, class VecIter, class DeqIter>
+void IgushArray<T, Alloc>::IgushArrayIterator<U, IgushArrayPtr, VecIter, DeqIter>::_next()
+{
+    if (_deq_it == _vec_it->end() && _vec_it < _ia->_v.end() - 1) {
+        ++_vec_it;
+        _deq_it = _vec_it->begin();
+    }
+    _cache();
+}
+
+template <class T, class Alloc>
+template <class U, class IgushArrayPtr, class VecIter, class DeqIter>
+void IgushArray<T, Alloc>::IgushArrayIterator<U, IgushArrayPtr, VecIter, DeqIter>::_prev()
+{
+    if (_deq_it == _vec_it->begin() && _vec_it != _ia->_v.begin()) {
+        --_vec_it;
+        _deq_it = _vec_it->end();
+    }
+    --_deq_it;
+    _cache();
+}
+
+template <class T, class Alloc>
+template <class U, class IgushArrayPtr, class VecIter, class DeqIter>
+void IgushArray<T, Alloc>::IgushArrayIterator<U, IgushArrayPtr, VecIter, DeqIter>::_seek(size_type n)
+{
+    size_type offset;
+    typename DeqTVec::size_type vec_n;
+    if (_ia->_block_mode != FULL) {
+        vec_n = _ia->_counts.find(n, offset);
+    }
+    else {
+        //The end is in the last DEQ even if it is full
+        vec_n = std::min(_ia->_vec_n(n), (typename DeqTVec::size_type)(_ia->_v.size() - 1));
+        offset = n - vec_n*_ia->_deq_size;
+    }
+    _vec_it = _ia->_v.begin() + vec_n;
+    _deq_it = _vec_it->begin() + offset;
+    _n = n;
+    _cache();
+}
+
+template <class T, class Alloc>
+IgushArray<T, Alloc>::IgushArray(const Alloc& a)
+: _v(DeqTAlloc(a)), _counts(a), _arena(a), _a(a), _pending(0)
+{
+    _reset();
+}
+
+template <class T, class Alloc>
+IgushArray<T, Alloc>::IgushArray(size_type n, const T& value, const Alloc& a)
+: _v(DeqTAlloc(a)), _storage_mode(HEAP), _sizing_mode(EXACT), _growth_mode(GEOMETRIC), _block_mode(FULL), _cascade_threads(1), _counts(a), _arena(a), _a(a), _pending(0)
+{
+    _reserve(n);
+    _push_back(OneValueIterator(0, value), OneValueIterator(n, value));
+}
+
+template <class T, class Alloc>
+template <class InputIterator>
+IgushArray<T, Alloc>::IgushArray(InputIterator first, InputIterator last, const Alloc& a)
+: _v(DeqTAlloc(a)), _storage_mode(HEAP), _sizing_mode(EXACT), _growth_mode(GEOMETRIC), _block_mode(FULL), _cascade_threads(1), _counts(a), _arena(a), _a(a), _pending(0)
+{
+    size_type n = data_size(first, last);
+    _reserve(n);
+    _push_back(first, last);
+}
+
+/**
+    The copy of the array whose structure and elements are allocated by the given allocator.
+*/
+template <class T, class Alloc>
+IgushArray<T, Alloc>::IgushArray(const IgushArray<T, Alloc>& ia, const Alloc& a)
+: _v(DeqTAlloc(a)), _storage_mode(ia._storage_mode), _sizing_mode(ia._sizing_mode), _growth_mode(ia._growth_mode), _block_mode(ia._block_mode), _cascade_threads(ia._cascade_threads), _counts(a), _arena(a), _a(a), _pending(0)
+{
+    _clone(ia);
+}
+
+/**
+    The structure is taken from the given array,
+    which is left empty in the default modes with no structure, so nothing is allocated.
+*/
+template <class T, class Alloc>
+IgushArray<T, Alloc>::IgushArray(IgushArray<T, Alloc>&& ia) noexcept
+: _capacity(ia._capacity), _v(std::move(ia._v)), _deq_size(ia._deq_size), _vec_size(ia._vec_size),
+  _storage_mode(ia._storage_mode), _sizing_mode(ia._sizing_mode), _growth_mode(ia._growth_mode), _block_mode(ia._block_mode),
+  _cascade_threads(ia._cascade_threads), _counts(std::move(ia._counts)), _deq_shift(ia._deq_shift), _deq_mask(ia._deq_mask),
+  _arena(std::move(ia._arena)), _a(ia._a), _pending(0)
+{
+    ia._reset();
+}
+
+/**
+    The allocator is taken with the copy only if it propagates on both copy assignment and swap.
+*/
+template <class T, class Alloc>
+IgushArray<T, Alloc>& IgushArray<T, Alloc>::operator=(const IgushArray<T, Alloc>& ia)
+{
+    bool propagate = AllocTraits::propagate_on_container_copy_assignment::value &&
+        AllocTraits::propagate_on_container_swap::value;
+    IgushArray<T, Alloc>(ia, propagate?ia._a:_a).swap(*this);
+    return *this;
+}
+
+/**
+    The structure is taken if the allocators are equal or the allocator propagates,
+    the given array is left as by the move constructor.
+    Otherwise the elements are moved to a structure allocated by the own allocator.
+*/
+template <class T, class Alloc>
+IgushArray<T, Alloc>& IgushArray<T, Alloc>::operator=(IgushArray<T, Alloc>&& ia)
+    noexcept(AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value)
+{
+    if (this == &ia)
+        return *this;
+
+    if (AllocTraits::propagate_on_container_move_assignment::value || _a == ia._a) {
+        _destroy();
+        _capacity = ia._capacity;
+        _v = std::move(ia._v);
+        _deq_size = ia._deq_size;
+        _vec_size = ia._vec_size;
+        _storage_mode = ia._storage_mode;
+        _sizing_mode = ia._sizing_mode;
+        _growth_mode = ia._growth_mode;
+        _block_mode = ia._block_mode;
+        _cascade_threads = ia._cascade_threads;
+        _counts = std::move(ia._counts);
+        _deq_shift = ia._deq_shift;
+        _deq_mask = ia._deq_mask;
+        _arena = std::move(ia._arena);
+        alloc_move_assign(_a, ia._a);
+        ia._reset();
+        return *this;
+    }
+    IgushArray<T, Alloc> moved(_a);
+    moved._reserve_like(ia, ia.size());
+    moved._push_back(std::make_move_iterator(ia.begin()), std::make_move_iterator(ia.end()));
+    swap(moved);
+    ia.clear();
+    return *this;
+}
+
+template <class T, class Alloc>
+IgushArray<T, Alloc>::~IgushArray()
+{
+    assert(!_pending);
+    _destroy();
+}
+
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::resize(size_type n, const T& value, ReserveMode reserve_mode)
+{
+    assert(!_pending);
+    size_type current_size = size();
+    bool grow = _grow_needed(n);
+
+    if ((n > _capacity && reserve_mode == IF_NEEDED) || reserve_mode == YES || grow) {
+        //we have to recalculate sizes
+
+        IgushArray ia(_a);
+        ia._reserve_like(*this, grow?2*n:n);
+        if (n >= current_size) {     //we have to add new elements
+            ia._push_back(std::make_move_iterator(begin()), std::make_move_iterator(end()));
+            ia._push_back(OneValueIterator(0, value), OneValueIterator(n - current_size, value));
+        }
+        else if (n < current_size) {    //we have to remove spare elements
+            std::move_iterator<iterator> first(begin());
+            ia._push_back(first, n);
+        }
+        swap(ia);
+    }
+    else {
+
+        //we have change the size only
+
+        if (n >= current_size)       //we have to add new elements
+            _push_back(OneValueIterator(0, value), OneValueIterator(n - current_size, value));
+        else if (n < current_size)  //we have to remove spare elements
+            _decrease_size(n);
+    }
+}
+
+
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::reserve(size_type n)
+{
+    assert(!_pending);
+    if (n <= _capacity)
+        return;
+
+    IgushArray ia(_a);
+    ia._reserve_like(*this, n);
+    ia._push_back(std::make_move_iterator(begin()), std::make_move_iterator(end()));
+    swap(ia);
+}
+
+/**
+    The arena mode carves the deque storage from a few slabs in the order of the deques.
+    The huge page mode maps the slabs in 2MB pages apart from the allocator,
+    so random access misses the TLB less often. Where there is no mmap it is the arena mode.
+*/
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::storage_mode(StorageMode storage_mode)
+{
+    if (storage_mode == _storage_mode)
+        return;
+
+    IgushArray ia(_a);
+    ia._destroy();
+    ia._storage_mode = storage_mode;
+    ia._sizing_mode = _sizing_mode;
+    ia._block_mode = _block_mode;
+    ia._growth_mode = _growth_mode;
+    ia._cascade_threads = _cascade_threads;
+    ia._reserve(_capacity);
+    ia._push_back(std::make_move_iterator(begin()), std::make_move_iterator(end()));
+    swap(ia);
+}
+
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::sizing_mode(SizingMode sizing_mode)
+{
+    if (sizing_mode == _sizing_mode)
+        return;
+
+    IgushArray ia(_a);
+    ia._destroy();
+    ia._storage_mode = _storage_mode;
+    ia._sizing_mode = sizing_mode;
+    ia._block_mode = _block_mode;
+    ia._growth_mode = _growth_mode;
+    ia._cascade_threads = _cascade_threads;
+    ia._reserve(_capacity);
+    ia._push_back(std::make_move_iterator(begin()), std::make_move_iterator(end()));
+    swap(ia);
+}
+
+/**
+    In the slack mode blocks are allowed to be half empty, so an insertion or an erasure
+    changes one or two blocks only instead of moving an element through every next block.
+    The position of an element is found by the element counts of the blocks.
+    The Fenwick mode keeps the counts in a Fenwick tree, so an edit which
+    does not split or merge blocks updates O(log B) counts instead of the counts
+    of all next blocks. A split or a merge still inserts or erases a block
+    in the directory and recounts the next blocks in O(B) time,
+    and a block keeps O(sqrt N) elements, so the edits are not polylogarithmic.
+*/
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::block_mode(BlockMode block_mode)
+{
+    if (block_mode == _block_mode)
+        return;
+
+    IgushArray ia(_a);
+    ia._destroy();
+    ia._storage_mode = _storage_mode;
+    ia._sizing_mode = _sizing_mode;
+    ia._block_mode = block_mode;
+    ia._growth_mode = _growth_mode;
+    ia._cascade_threads = _cascade_threads;
+    ia._reserve(_capacity);
+    ia._push_back(std::make_move_iterator(begin()), std::make_move_iterator(end()));
+    swap(ia);
+}
+
+/**
+    Returns the number of bytes the structure uses above the elements themselves:
+    the object, the directory, free slots of the deques and unused arena chunks.
+*/
+template <class T, class Alloc>
+typename IgushArray<T, Alloc>::size_type IgushArray<T, Alloc>::memory_overhead() const
+{
+    size_type overhead = sizeof(*this) + _v.capacity()*sizeof(DeqT) + _counts.capacity()*sizeof(size_type);
+    overhead += (_v.size()*_deq_size - size())*sizeof(T);
+    if (_storage_mode != HEAP)
+        overhead += (_arena.capacity() - _v.size())*_deq_size*sizeof(T);
+    return overhead;
+}
+
+/**
+    Calls the function for the contiguous segments of the elements of the range in their order,
+    the function takes the pointer to the first element of a segment and its size.
+    Every deque gives one segment, or two if its elements wrap around the end of its storage.
+*/
+template <class T, class Alloc>
+template <class Function>
+Function IgushArray<T, Alloc>::for_each_segment(iterator first, iterator last, Function f)
+{
+    if (first == last)
+        return f;
+    DeqTVecIter vec_it = first._vec_it;
+    size_type from = first._deq_it - vec_it->begin();
+    for (; vec_it != last._vec_it; ++vec_it, from = 0)
+        vec_it->_for_pieces(f, from, vec_it->size());
+    vec_it->_for_pieces(f, from, last._deq_it - vec_it->begin());
+    return f;
+}
+
+template <class T, class Alloc>
+template <class Function>
+Function IgushArray<T, Alloc>::for_each_segment(const_iterator first, const_iterator last, Function f) const
+{
+    if (first == last)
+        return f;
+    DeqTVecConstIter vec_it = first._vec_it;
+    size_type from = first._deq_it - vec_it->begin();
+    for (; vec_it != last._vec_it; ++vec_it, from = 0)
+        vec_it->_for_pieces(f, from, vec_it->size());
+    vec_it->_for_pieces(f, from, last._deq_it - vec_it->begin());
+    return f;
+}
+
+/**
+    Returns the position of the first element equal to the value, or the end.
+    The DEQs are searched by SegmentKernels over their contiguous pieces.
+*/
+template <class T, class Alloc>
+typename IgushArray<T, Alloc>::Position IgushArray<T, Alloc>::_find(const T& value) const
+{
+    for (typename DeqTVec::size_type vec_n = 0; vec_n < _v.size(); ++vec_n) {
+        size_type deq_n = 0;
+        bool found = false;
+        auto piece = [&value, &deq_n, &found](const T* first, size_type n) {
+            if (found)
+                return;
+            size_type i = SegmentKernels<T>::find(first, n, value);
+            deq_n += i;
+            found = (i != n);
+        };
+        _v[vec_n]._for_pieces(piece);
+        if (found)
+            return Position(vec_n, deq_n);
+    }
+    return Position(_v.size(), 0);
+}
+
+template <class T, class Alloc>
+typename IgushArray<T, Alloc>::size_type IgushArray<T, Alloc>::count(const T& value) const
+{
+    size_type c = 0;
+    auto piece = [&value, &c](const T* first, size_type n) {
+        c += SegmentKernels<T>::count(first, n, value);
+    };
+    for (typename DeqTVec::const_iterator it = _v.begin(); it != _v.end(); ++it)
+        it->_for_pieces(piece);
+    return c;
+}
+
+/**
+    Returns the position of the first smallest or largest element, or the end if the array is empty.
+*/
+template <class T, class Alloc>
+typename IgushArray<T, Alloc>::Position IgushArray<T, Alloc>::_extreme(bool max) const
+{
+    Position pos(_v.size(), 0);
+    if (empty())
+        return pos;
+
+    const T* extreme = &_v.front().front();
+    pos = Position(0, 0);
+    for (typename DeqTVec::size_type vec_n = 0; vec_n < _v.size(); ++vec_n) {
+        size_type deq_n = 0;
+        auto piece = [&](const T* first, size_type n) {
+            const T* found = max?SegmentKernels<T>::max_element(first, n, extreme):
+                SegmentKernels<T>::min_element(first, n, extreme);
+            if (found != extreme) {
+                extreme = found;
+                pos = Position(vec_n, deq_n + (found - first));
+            }
+            deq_n += n;
+        };
+        _v[vec_n]._for_pieces(piece);
+    }
+    return pos;
+}
+
+/**
+    Erases the elements for which the function returns true in one pass:
+    the kept elements are moved to the front over the segments of the DEQs
+    and the rest at the end is erased together with the emptied DEQs.
+    If the size falls below a quarter of the squared DEQ size in the geometric
+    growth mode, the structure is re-blocked for twice the size like on growth.
+    The function takes the element and the last kept one, null if there is none.
+    Returns the number of the erased elements.
+*/
+template <class T, class Alloc>
+template <class Remove>
+typename IgushArray<T, Alloc>::size_type IgushArray<T, Alloc>::_compact(Remove remove)
+{
+    iterator to = begin();
+    const T* kept = 0;
+    bool moving = false;
+    auto segment = [&remove, &to, &kept, &moving](T* elem, size_type n) {
+        for (T* last = elem + n; elem != last; ++elem) {
+            if (remove(*elem, kept)) {
+                moving = true;
+                continue;
+            }
+            if (moving)
+                *to = std::move(*elem);
+            kept = &*to;
+            ++to;
+        }
+    };
+    for_each_segment(segment);
+
+    size_type n = end() - to;
+    erase(to, end());
+
+    //The DEQs left after a big compaction are too long for the size
+    if (_shrink_needed(size())) {
+        IgushArray ia(_a);
+        ia._reserve_like(*this, 2*size());
+        ia._push_back(std::make_move_iterator(begin()), std::make_move_iterator(end()));
+        swap(ia);
+    }
+    return n;
+}
+
+/**
+    Adds the elements to the initial value in their order, by SegmentKernels over contiguous pieces.
+*/
+template <class T, class Alloc>
+template <class U>
+U IgushArray<T, Alloc>::accumulate(U init) const
+{
+    auto piece = [&init](const T* first, size_type n) {
+        init = SegmentKernels<T>::accumulate(first, n, init);
+    };
+    for (typename DeqTVec::const_iterator it = _v.begin(); it != _v.end(); ++it)
+        it->_for_pieces(piece);
+    return init;
+}
+
+/**
+    The function is called for every element, the blocks are given to the threads
+    as they are free. The function must be safe to call from several threads at once.
+    By default there is one thread per core.
+*/
+template <class T, class Alloc>
+template <class UnaryFunction>
+void IgushArray<T, Alloc>::parallel_for_each(UnaryFunction f, unsigned threads)
+{
+    _parallel_blocks([this, &f](typename DeqTVec::size_type vec_n) {
+        auto piece = [&f](T* first, size_type n) {
+            for (T* last = first + n; first != last; ++first)
+                f(*first);
+        };
+        _v[vec_n]._for_pieces(piece);
+    }, threads);
+}
+
+/**
+    Every block is reduced by its thread, then the results are combined
+    in the order of the blocks, so the operation has to be associative only.
+*/
+template <class T, class Alloc>
+template <class U, class BinaryOperation>
+U IgushArray<T, Alloc>::parallel_reduce(U init, BinaryOperation op, unsigned threads) const
+{
+    if (empty())
+        return init;
+
+    typedef std::vector<U, typename AllocTraits::template rebind_alloc<U> > UVec;
+    UVec totals(_v.size(), init, _a);
+    _parallel_blocks([this, &op, &totals](typename DeqTVec::size_type vec_n) {
+        U& total = totals[vec_n];
+        bool first_piece = true;
+        auto piece = [&op, &total, &first_piece](const T* first, size_type n) {
+            const T* last = first + n;
+            if (first_piece) {
+                total = *first++;
+                first_piece = false;
+            }
+            for (; first != last; ++first)
+                total = op(total, *first);
+        };
+        _v[vec_n]._for_pieces(piece);
+    }, threads);
+
+    for (typename UVec::const_iterator it = totals.begin(); it != totals.end(); ++it)
+        init = op(init, *it);
+    return init;
+}
+
+/**
+    The output array is resized to the size of the array and every thread
+    writes the results of its block starting from the position of the block.
+    The output array may be the array itself.
+*/
+template <class T, class Alloc>
+template <class U, class AllocU, class UnaryOperation>
+void IgushArray<T, Alloc>::parallel_transform(IgushArray<U, AllocU>& out, UnaryOperation op, unsigned threads) const
+{
+    out.resize(size());
+    _parallel_blocks([this, &out, &op](typename DeqTVec::size_type vec_n) {
+        typename IgushArray<U, AllocU>::iterator to = out.begin() + _before(vec_n);
+        auto piece = [&op, &to](const T* first, size_type n) {
+            for (const T* last = first + n; first != last; ++first, ++to)
+                *to = op(*first);
+        };
+        _v[vec_n]._for_pieces(piece);
+    }, threads);
+}
+
+/**
+    The totals of the blocks are calculated in parallel, then the totals of the previous blocks
+    are summed one by one and every block is scanned in parallel from the sum.
+*/
+template <class T, class Alloc>
+template <class BinaryOperation>
+void IgushArray<T, Alloc>::parallel_inclusive_scan(BinaryOperation op, unsigned threads)
+{
+    if (empty())
+        return;
+
+    std::vector<T, Alloc> totals = _block_totals(op, threads);
+    T sum(totals[0]);
+    for (typename std::vector<T, Alloc>::iterator it = totals.begin() + 1; it != totals.end(); ++it) {
+        std::swap(sum, *it);
+        sum = op(*it, sum);
+    }
+
+    _parallel_blocks([this, &op, &totals](typename DeqTVec::size_type vec_n) {
+        T sum(totals[vec_n]);
+        bool first_piece = (vec_n == 0);
+        auto piece = [&op, &sum, &first_piece](T* first, size_type n) {
+            T* last = first + n;
+            if (first_piece) {
+                sum = *first++;
+                first_piece = false;
+            }
+            for (; first != last; ++first)
+                *first = sum = op(sum, *first);
+        };
+        _v[vec_n]._for_pieces(piece);
+    }, threads);
+}
+
+template <class T, class Alloc>
+template <class BinaryOperation>
+void IgushArray<T, Alloc>::parallel_exclusive_scan(const T& init, BinaryOperation op, unsigned threads)
+{
+    if (empty())
+        return;
+
+    std::vector<T, Alloc> totals = _block_totals(op, threads);
+    T sum(init);
+    for (typename std::vector<T, Alloc>::iterator it = totals.begin(); it != totals.end(); ++it) {
+        std::swap(sum, *it);
+        sum = op(*it, sum);
+    }
+
+    _parallel_blocks([this, &op, &totals](typename DeqTVec::size_type vec_n) {
+        T sum(totals[vec_n]);
+        auto piece = [&op, &sum](T* first, size_type n) {
+            for (T* last = first + n; first != last; ++first) {
+                T val(std::move(*first));
+                *first = sum;
+                sum = op(sum, val);
+            }
+        };
+        _v[vec_n]._for_pieces(piece);
+    }, threads);
+}
+
+template <class T, class Alloc>
+typename IgushArray<T, Alloc>::reference IgushArray<T, Alloc>::_element(size_type n)
+{
+    if (_block_mode != FULL) {
+        size_type offset;
+        typename DeqTVec::size_type vec_n = _counts.find(n, offset);
+        return _v[vec_n][offset];
+    }
+    if (_sizing_mode == POW2)
+        return _v[n >> _deq_shift]._masked(n & _deq_mask, _deq_mask);
+    typename DeqTVec::size_type vec_n = n/_deq_size;
+    return _v[vec_n][n-vec_n*_deq_size];
+}
+
+template <class T, class Alloc>
+typename IgushArray<T, Alloc>::const_reference IgushArray<T, Alloc>::_element(size_type n) const
+{
+    if (_block_mode != FULL) {
+        size_type offset;
+        typename DeqTVec::size_type vec_n = _counts.find(n, offset);
+        return _v[vec_n][offset];
+    }
+    if (_sizing_mode == POW2)
+        return _v[n >> _deq_shift]._masked(n & _deq_mask, _deq_mask);
+    typename DeqTVec::size_type vec_n = n/_deq_size;
+    return _v[vec_n][n-vec_n*_deq_size];
+}
+
+template <class T, class Alloc>
+typename IgushArray<T, Alloc>::reference IgushArray<T, Alloc>::at(size_type n)
+{
+    if (_pending) {
+        if (n >= _pending->size())
+            throw std::out_of_range("at(): The size has been exceeded");
+        return _pending->_element(n);
+    }
+    if (_block_mode != FULL) {
+        size_type offset;
+        typename DeqTVec::size_type vec_n = _counts.find(n, offset);
+        return _v[vec_n].at(offset);
+    }
+    typename DeqTVec::size_type vec_n = _vec_n(n);
+    return _v.at(vec_n).at(n-vec_n*_deq_size);
+}
+
+template <class T, class Alloc>
+typename IgushArray<T, Alloc>::const_reference IgushArray<T, Alloc>::at(size_type n) const
+{
+    if (_pending) {
+        if (n >= _pending->size())
+            throw std::out_of_range("at(): The size has been exceeded");
+        return _pending->_element(n);
+    }
+    if (_block_mode != FULL) {
+        size_type offset;
+        typename DeqTVec::size_type vec_n = _counts.find(n, offset);
+        return _v[vec_n].at(offset);
+    }
+    typename DeqTVec::size_type vec_n = _vec_n(n);
+    return _v.at(vec_n).at(n-vec_n*_deq_size);
+}
+
+template <class T, class Alloc>
+template <class InputIterator>
+void IgushArray<T, Alloc>::assign(InputIterator first, InputIterator last, ReserveMode reserve_mode)
+{
+    size_type current_size = size();
+    size_type n = data_size(first, last);
+    bool grow = _grow_needed(n);
+
+    if ((n > _capacity && reserve_mode == IF_NEEDED) || reserve_mode == YES || grow) {
+        //we have to recalculate sizes
+
+        IgushArray ia(_a);
+        ia._reserve_like(*this, grow?2*n:n);
+        ia._push_back(first, last);
+        swap(ia);
+    }
+    else {
+        //we have change the size only
+
+        if (n >= current_size) {
+            _fill(begin(), first, current_size);
+            _push_back(first, last);
+        }
+        else if (n < current_size) {
+            _decrease_size(n);
+            _fill(begin(), first, last);
+        }
+    }
+}
+
+template <class T, class Alloc>
+template <class... Args>
+void IgushArray<T, Alloc>::emplace_back(Args&&... args)
+{
+    assert(!_pending);
+    if (_v.empty())
+        _reserve(0);
+    if (_v.back().size() == _deq_size) {
+        //Re-block to the doubled size, so the rebuilding is amortized constant
+        //The element is created first since the arguments may refer to an element
+        if (_grow_needed(size() + 1)) {
+            T temp(std::forward<Args>(args)...);
+            reserve(2*(size() + 1));
+            emplace_back(std::move(temp));
+            return;
+        }
+        _v.push_back(_new_deque());
+        if (_block_mode != FULL)
+            _counts.push_back(0);
+    }
+    _v.back().emplace_back(std::forward<Args>(args)...);
+    if (_block_mode != FULL)
+        _counts.add(_v.size() - 1, 1);
+}
+
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::pop_back()
+{
+    _v.back().pop_back();
+    if (_block_mode != FULL)
+        _counts.add(_v.size() - 1, -1);
+    if (_v.back().empty() && _v.size() > 1) {
+        _delete_deque(_v.back());
+        _v.pop_back();
+        if (_block_mode != FULL)
+            _counts.pop_back();
+    }
+}
+
+/**
+    The new element takes its place and the last element of every next deque
+    is carried to the front of the following one. Full deques are just turned,
+    so each of them takes constant time and no element is copied.
+*/
+template <class T, class Alloc>
+template <class... Args>
+typename IgushArray<T, Alloc>::iterator IgushArray<T, Alloc>::emplace(iterator it, Args&&... args)
+{
+    if (_v.empty()) {
+        _reserve(0);
+        it = begin();
+    }
+    if (_block_mode != FULL)
+        return _slack_emplace(it, std::forward<Args>(args)...);
+
+    size_type result = it-begin();
+
+    //If the last deque has a room, just insert the new element
+    if (it._vec_it == _v.end()-1 && it._vec_it->size() < _deq_size) {
+        it._vec_it->emplace(it._deq_it, std::forward<Args>(args)...);
+        return begin()+result;
+    }
+
+    T carry(std::forward<Args>(args)...);
+
+    //If the iterator does not point to the end of the deque, put the new element to its place
+    DeqTVecIter _vec_it = it._vec_it;
+    if (it._deq_it != _vec_it->end())
+        _vec_it->_insert_full(it._deq_it - _vec_it->begin(), carry);
+
+    //Move the rest of elements to the end
+    for (++_vec_it; _vec_it != _v.end(); ++_vec_it) {
+        if (_vec_it->size() < _deq_size) {
+            _vec_it->push_front(std::move(carry));
+            return begin()+result;
+        }
+        _vec_it->_rotate_front(carry);
+    }
+
+    emplace_back(std::move(carry));
+    return begin()+result;
+}
+
+template <class T, class Alloc>
+template <class InputIterator>
+typename IgushArray<T, Alloc>::iterator IgushArray<T, Alloc>::insert(iterator it, InputIterator first, InputIterator last, ReserveMode reserve_mode)
+{
+    if (_v.empty()) {
+        _reserve(0);
+        it = begin();
+    }
+    size_type result = it-begin();
+
+    //Define how many new elements should be inserted
+    size_type n = data_size(first, last);
+
+    //Define total new size
+    size_type total_new_size = size() + n;
+    
+    bool grow = _grow_needed(total_new_size);
+
+    if ((total_new_size > _capacity && reserve_mode == IF_NEEDED) || reserve_mode == YES || grow) {
+        //we have to recalculate sizes
+
+        IgushArray ia(_a);
+        ia._reserve_like(*this, grow?2*total_new_size:total_new_size);
+        ia._push_back(std::make_move_iterator(begin()), std::make_move_iterator(it));
+        ia._push_back(first, last);
+        ia._push_back(std::make_move_iterator(it), std::make_move_iterator(end()));
+        swap(ia);
+    }
+    else if (_block_mode != FULL) {
+        _slack_insert(it, first, last, n);
+    }
+    else {
+        //Define important values in it queue
+        typename DeqT::size_type size_to_end = it._vec_it->end() - it._deq_it;
+        typename DeqT::size_type empty_to_end = _deq_size - it._vec_it->size();
+        typename DeqT::size_type capacity_to_end = size_to_end + empty_to_end;
+        typename DeqTVec::size_type vec_n = it._vec_it - _v.begin();
+
+        //The elements carried to the next deques
+        DeqT carry = _new_deque();
+
+        if (n > capacity_to_end) {
+            //The new elements which do not fill whole deques and the end of the current deque
+            //make one more deque if they are enough, the rest of them is carried
+            size_type rest = (n - capacity_to_end) % _deq_size;
+            bool extra = (rest + size_to_end >= _deq_size);
+            n -= capacity_to_end + rest;
+
+            DeqTVec new_deques(_v.get_allocator());
+            new_deques.reserve(n/_deq_size + extra);
+            for (size_type i = 0; i < n/_deq_size + extra; ++i)
+                new_deques.push_back(_new_deque());
+
+            InputIterator mid = first;
+            std::advance(mid, capacity_to_end + n);
+            std::move_iterator<DeqTIter> tail(it._deq_it);
+            if (extra) {
+                new_deques.back()._append(mid, rest);
+                new_deques.back()._append(tail, _deq_size - rest);
+                carry._append(tail, rest + size_to_end - _deq_size);
+            }
+            else {
+                carry._append(mid, rest);
+                carry._append(tail, size_to_end);
+            }
+            it._vec_it->erase(it._deq_it, it._vec_it->end());
+
+            //Fill the end of the current deque and the new deques with the new elements
+            it._vec_it->_append(first, capacity_to_end);
+            for (DeqTVecIter vec_it = new_deques.begin(); n; ++vec_it, n -= _deq_size)
+                vec_it->_append(first, _deq_size);
+
+            //Insert them into the directory at once
+            _v.insert(_v.begin() + vec_n + 1, std::make_move_iterator(new_deques.begin()),
+                std::make_move_iterator(new_deques.end()));
+            vec_n += new_deques.size();
+        }
+        else {
+            //Save the end of the current deque
+            if (n > empty_to_end) {
+                std::move_iterator<DeqTIter> tail(it._vec_it->end() - (n - empty_to_end));
+                carry._append(tail, n - empty_to_end);
+                it._vec_it->erase(it._vec_it->end() - (n - empty_to_end), it._vec_it->end());
+            }
+
+            //Insert the new elements
+            it._vec_it->insert(it._deq_it, first, last);
+        }
+
+        _carry_front(vec_n + 1, carry);
+    }
+    return begin()+result;
+}
+
+/**
+    Puts the carried elements to the front of the deque and carries its last elements
+    to the next one. A full deque is turned by the number of the carried elements
+    swapping them with its last elements, so no buffer but the carried deque is used.
+    The carried deque becomes the last deque if the elements do not fit in the structure.
+*/
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::_carry_front(typename DeqTVec::size_type vec_n, DeqT& carry)
+{
+    size_type move = carry.size();
+
+    typename DeqTVec::size_type full_end = _v.size() - (_v.back().size() < _deq_size);
+    unsigned chunks = _cascade_chunks(full_end - std::min(vec_n, full_end), move);
+    if (chunks > 1) {
+        _carry_front(vec_n, full_end, carry, chunks);
+        vec_n = full_end;
+    }
+
+    for (; move && vec_n < _v.size(); ++vec_n) {
+        DeqT& deq = _v[vec_n];
+        if (deq.size() == _deq_size) {
+            for (size_type i = move; i-- > 0;)
+                deq._rotate_front(carry[i]);
+            continue;
+        }
+
+        if (deq.size() + move <= _deq_size) {
+            for (size_type i = move; i-- > 0;)
+                deq.push_front(std::move(carry[i]));
+            move = 0;
+            break;
+        }
+
+        //The carried deque takes the head of the last deque and its place
+        std::move_iterator<DeqTIter> head(deq.begin());
+        size_type head_size = _deq_size - move;
+        carry._append(head, head_size);
+        deq.erase(deq.begin(), deq.begin() + head_size);
+        std::swap(deq, carry);
+        move = carry.size();
+    }
+
+    if (move)
+        _v.push_back(std::move(carry));
+    else
+        _delete_deque(carry);
+}
+
+/**
+    Moves n elements from the front of the next deque to the back of the deque,
+    or all of them if there are less.
+*/
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::_pull_front(DeqT& deq, DeqT& next, size_type n)
+{
+    n = std::min(n, next.size());
+    std::move_iterator<DeqTIter> from(next.begin());
+    deq._append(from, n);
+    for (; n; --n)
+        next.pop_front();
+}
+
+template <class T, class Alloc>
+unsigned IgushArray<T, Alloc>::_cascade_chunks(typename DeqTVec::size_type vec_count, size_type move) const
+{
+    size_type chunks = vec_count*move/_thread_moves;
+    if (chunks > _cascade_threads)
+        chunks = _cascade_threads;
+    return (chunks > vec_count)?vec_count:chunks;
+}
+
+/**
+    The full deques are split into ranges of adjacent deques, one per thread.
+    The last elements of the deque before every range are taken out first,
+    so every range is turned with its own carried elements independently.
+    The elements carried out of the last range are left in the carried deque.
+*/
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::_carry_front(typename DeqTVec::size_type vec_n,
+    typename DeqTVec::size_type vec_end, DeqT& carry, unsigned chunks)
+{
+    size_type move = carry.size();
+    std::vector<typename DeqTVec::size_type> bounds(chunks + 1);
+    for (unsigned k = 0; k <= chunks; ++k)
+        bounds[k] = vec_n + (vec_end - vec_n)*k/chunks;
+
+    DeqTVec carries(_v.get_allocator());
+    carries.reserve(chunks - 1);
+    for (unsigned k = 1; k < chunks; ++k) {
+        DeqT& deq = _v[bounds[k] - 1];
+        std::move_iterator<DeqTIter> tail(deq.end() - move);
+        carries.push_back(_new_deque());
+        carries.back()._append(tail, move);
+        deq.erase(deq.end() - move, deq.end());
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(chunks - 1);
+    for (unsigned k = 1; k < chunks; ++k)
+        threads.push_back(std::thread(&IgushArray<T, Alloc>::_turn_front, this,
+            bounds[k], bounds[k + 1], std::ref(carries[k - 1])));
+    _turn_front(bounds[0], bounds[1], carry);
+    for (unsigned k = 1; k < chunks; ++k)
+        threads[k - 1].join();
+
+    std::swap(carry, carries.back());
+    for (DeqTVecIter vec_it = carries.begin(); vec_it != carries.end(); ++vec_it)
+        _delete_deque(*vec_it);
+}
+
+/**
+    Turns every deque of the range by the carried elements. The last deque of the range
+    is not full if its last elements have been taken out, then it just takes them.
+*/
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::_turn_front(typename DeqTVec::size_type vec_n,
+    typename DeqTVec::size_type vec_end, DeqT& carry)
+{
+    size_type move = carry.size();
+    for (; vec_n != vec_end; ++vec_n) {
+        DeqT& deq = _v[vec_n];
+        if (deq.size() == _deq_size)
+            for (size_type i = move; i-- > 0;)
+                deq._rotate_front(carry[i]);
+        else
+            for (size_type i = move; i-- > 0;)
+                deq.push_front(std::move(carry[i]));
+    }
+}
+
+/**
+    The deques are split into ranges of adjacent deques, one per thread.
+    The first elements of the first deque of every range are taken out first,
+    so the last deque of the previous range takes them without waiting for the range.
+*/
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::_pull_front(typename DeqTVec::size_type vec_n,
+    typename DeqTVec::size_type vec_end, size_type move, unsigned chunks)
+{
+    std::vector<typename DeqTVec::size_type> bounds(chunks + 1);
+    for (unsigned k = 0; k <= chunks; ++k)
+        bounds[k] = vec_n + (vec_end - vec_n)*k/chunks;
+
+    DeqTVec heads(_v.get_allocator());
+    heads.reserve(chunks - 1);
+    for (unsigned k = 1; k < chunks; ++k) {
+        heads.push_back(_new_deque());
+        _pull_front(heads.back(), _v[bounds[k]], move);
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(chunks - 1);
+    for (unsigned k = 1; k < chunks; ++k)
+        threads.push_back(std::thread((void (IgushArray<T, Alloc>::*)(typename DeqTVec::size_type,
+            typename DeqTVec::size_type, size_type, DeqT*))&IgushArray<T, Alloc>::_pull_front, this,
+            bounds[k], bounds[k + 1], move, (k + 1 < chunks)?&heads[k]:(DeqT*)0));
+    _pull_front(bounds[0], bounds[1], move, &heads[0]);
+    for (unsigned k = 1; k < chunks; ++k)
+        threads[k - 1].join();
+
+    for (DeqTVecIter vec_it = heads.begin(); vec_it != heads.end(); ++vec_it)
+        _delete_deque(*vec_it);
+}
+
+/**
+    Every deque of the range takes the first elements of the next one,
+    the last deque of the range takes them from the given deque if any.
+*/
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::_pull_front(typename DeqTVec::size_type vec_n,
+    typename DeqTVec::size_type vec_end, size_type move, DeqT* next)
+{
+    for (; vec_n + 1 < vec_end; ++vec_n)
+        _pull_front(_v[vec_n], _v[vec_n + 1], move);
+    _pull_front(_v[vec_n], next?*next:_v[vec_n + 1], move);
+}
+
+/**
+    The first element of every next deque is carried to the back of the previous one,
+    the same way as for insertion in the opposite direction.
+*/
+template <class T, class Alloc>
+typename IgushArray<T, Alloc>::iterator IgushArray<T, Alloc>::erase(iterator it)
+{
+    if (_block_mode != FULL) {
+        iterator next = it;
+        return erase(it, ++next);
+    }
+
+    size_type result = it-begin();
+
+    DeqTVecIter _vec_it = _v.end() - 1;
+    if (it._vec_it == _vec_it) {
+        _vec_it->erase(it._deq_it);
+    }
+    else {
+        //Move one element up
+        T carry(std::move(_vec_it->front()));
+        _vec_it->pop_front();
+        for (--_vec_it; _vec_it != it._vec_it; --_vec_it)
+            _vec_it->_rotate_back(carry);
+        _vec_it->_erase_full(it._deq_it - _vec_it->begin(), carry);
+    }
+
+    //Check last queue if it's empty
+    if (_v.back().empty() && _v.size() > 1) {
+        _delete_deque(_v.back());
+        _v.pop_back();
+    }
+
+    return begin()+result;
+}
+
+template <class T, class Alloc>
+typename IgushArray<T, Alloc>::iterator IgushArray<T, Alloc>::erase(iterator it_first, iterator it_last)
+{
+    if (it_first >= it_last)
+        return it_first;
+
+    size_type result = it_first-begin();
+    if (_block_mode != FULL) {
+        _slack_erase(it_first, it_last);
+        return begin()+result;
+    }
+
+    //Erase the range from the first and the last deques
+    typename DeqTVec::size_type vec_n = it_first._vec_it - _v.begin();
+    if (it_first._vec_it == it_last._vec_it) {
+        it_first._vec_it->erase(it_first._deq_it, it_last._deq_it);
+    }
+    else {
+        it_first._vec_it->erase(it_first._deq_it, it_first._vec_it->end());
+        it_last._vec_it->erase(it_last._vec_it->begin(), it_last._deq_it);
+
+        //The last deque fills the first one and is erased too if nothing is left
+        _pull_front(*it_first._vec_it, *it_last._vec_it, _deq_size - it_first._vec_it->size());
+        bool last_left = !it_last._vec_it->empty();
+
+        //Remove the deques between them from the directory at once
+        DeqTVecIter last_to_be_erased = it_last._vec_it + !last_left;
+        for (DeqTVecIter to_be_erased = it_first._vec_it + 1; to_be_erased != last_to_be_erased; ++to_be_erased)
+            _delete_deque(*to_be_erased);
+        _v.erase(it_first._vec_it + 1, last_to_be_erased);
+
+        if (last_left)
+            ++vec_n;
+    }
+
+    //Every next deque gives its first elements to the previous one
+    size_type move = _deq_size - _v[vec_n].size();
+    unsigned chunks = _cascade_chunks(_v.size() - 1 - vec_n, move);
+    if (chunks > 1)
+        _pull_front(vec_n, _v.size() - 1, move, chunks);
+    else if (move)
+        for (; vec_n + 1 < _v.size(); ++vec_n)
+            _pull_front(_v[vec_n], _v[vec_n + 1], move);
+
+    //Check last queue if it's empty
+    if (_v.back().empty() && _v.size() > 1) {
+        _delete_deque(_v.back());
+        _v.pop_back();
+    }
+
+    return begin()+result;
+}
+
+/**
+    The value is assigned if both edits are insertions, otherwise it is created or destroyed.
+    The value is read only if the given edit is an insertion.
+*/
+template <class T, class Alloc>
+template <class V>
+void IgushArray<T, Alloc>::Edit::_assign(const Edit& e, V&& val)
+{
+    if (kind == INSERT && e.kind == INSERT) {
+        value = std::forward<V>(val);
+    }
+    else if (e.kind == INSERT) {
+        new (&value) T(std::forward<V>(val));
+        kind = INSERT;
+    }
+    else if (kind == INSERT) {
+        value.~T();
+        kind = ERASE;
+    }
+    pos = e.pos;
+}
+
+/**
+    Applies a batch of insertions and erasures numbered in the array before the edits.
+    The values inserted before the same element keep their order in the batch.
+    The edits are sorted by number and the difference of the size is inserted or erased at once.
+    The kept elements from the first edited one to the last one are moved to their places:
+    those going to the front in their order and those going to the back in the reverse order,
+    then the inserted values are copied to the places left. So no element of the array is lost
+    if a copy throws, only the places of the inserted values may be left with other values.
+    A small batch spread over a large range is applied edit by edit from the end.
+*/
+template <class T, class Alloc>
+template <class ForwardIterator>
+void IgushArray<T, Alloc>::apply_edits(ForwardIterator first, ForwardIterator last)
+{
+    typedef std::vector<const Edit*, typename AllocTraits::template rebind_alloc<const Edit*> > EditVec;
+    EditVec edits(_a);
+    for (; first != last; ++first)
+        edits.push_back(&*first);
+    if (edits.empty())
+        return;
+    std::stable_sort(edits.begin(), edits.end(), [](const Edit* e1, const Edit* e2)
+        { return e1->pos < e2->pos || (e1->pos == e2->pos && e1->kind < e2->kind); });
+
+    //Check the whole batch before the array is changed
+    size_type n = size(), inserted = 0;
+    for (typename EditVec::size_type i = 0; i < edits.size(); ++i) {
+        if (edits[i]->kind == Edit::INSERT) {
+            if (edits[i]->pos > n)
+                throw std::out_of_range("apply_edits(): The size has been exceeded");
+            ++inserted;
+            continue;
+        }
+        if (edits[i]->pos >= n)
+            throw std::out_of_range("apply_edits(): The size has been exceeded");
+        if (i && edits[i-1]->kind == Edit::ERASE && edits[i-1]->pos == edits[i]->pos)
+            throw std::invalid_argument("apply_edits(): The element is erased twice");
+    }
+
+    //The elements from the first edited one to the last one
+    size_type from = edits.front()->pos;
+    size_type to = edits.back()->pos + (edits.back()->kind == Edit::ERASE);
+    if (edits.size()*_deq_size < 2*(to - from)) {
+        for (typename EditVec::reverse_iterator it = edits.rbegin(); it != edits.rend(); ++it)
+            if ((*it)->kind == Edit::INSERT)
+                insert(begin() + (*it)->pos, (*it)->value);
+            else
+                erase(begin() + (*it)->pos);
+        return;
+    }
+
+    //The places for more elements are made after the range
+    size_type erased = edits.size() - inserted;
+    if (inserted > erased) {
+        typename EditVec::iterator e = edits.begin();
+        while ((*e)->kind != Edit::INSERT)
+            ++e;
+        insert(begin() + to, inserted - erased, (*e)->value);
+    }
+
+    //Every kept element is shifted by the insertions minus the erasures before it
+    difference_type shift = 0;
+    size_type pos = from;
+    for (typename EditVec::iterator e = edits.begin(); e != edits.end(); ++e) {
+        if (shift < 0 && pos < (*e)->pos)
+            std::move(begin() + pos, begin() + (*e)->pos, begin() + ((difference_type)pos + shift));
+        pos = (*e)->pos;
+        if ((*e)->kind == Edit::INSERT)
+            ++shift;
+        else
+            --shift, ++pos;
+    }
+    pos = to;
+    for (typename EditVec::reverse_iterator e = edits.rbegin(); e != edits.rend(); ++e) {
+        size_type run = (*e)->pos + ((*e)->kind == Edit::ERASE);
+        if (shift > 0 && run < pos)
+            std::move_backward(begin() + run, begin() + pos, begin() + ((difference_type)pos + shift));
+        pos = (*e)->pos;
+        shift += ((*e)->kind == Edit::INSERT)?-1:1;
+    }
+
+    //The places left after the range are erased
+    if (erased > inserted)
+        erase(begin() + (to - (erased - inserted)), begin() + to);
+
+    iterator it = begin() + from;
+    pos = from;
+    for (typename EditVec::iterator e = edits.begin(); e != edits.end(); ++e) {
+        if ((*e)->kind != Edit::INSERT) {
+            --shift;
+            continue;
+        }
+        size_type place = (*e)->pos + shift++;
+        it += (difference_type)(place - pos);
+        pos = place;
+        *it = (*e)->value;
+    }
+}
+
+/**
+    Replaces n elements from the given number by the values. The size is changed first:
+    the rest of the values is inserted or the rest of the elements is erased at once,
+    then the values are moved over the elements.
+*/
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::_replace(size_type pos, size_type n, std::vector<T, Alloc>& values)
+{
+    size_type common = std::min(n, (size_type)values.size());
+    if (common < values.size())
+        insert(begin() + (pos + n), std::make_move_iterator(values.begin() + common), std::make_move_iterator(values.end()));
+    else if (common < n)
+        erase(begin() + (pos + common), begin() + (pos + n));
+    std::move(values.begin(), values.begin() + common, begin() + pos);
+}
+
+/**
+    Returns a cursor before the element with the given number.
+    While the cursor has edits, size(), empty(), operator[] and at() of the array
+    read it through the cursor. The iterators, front(), back() and the changes
+    of the array are asserted against until the cursor is flushed.
+    Only one cursor may have edits at a time.
+*/
+template <class T, class Alloc>
+typename IgushArray<T, Alloc>::Cursor IgushArray<T, Alloc>::cursor(size_type pos)
+{
+    if (_pending)
+        throw std::logic_error("cursor(): Another cursor has edits");
+    if (pos > size())
+        throw std::out_of_range("cursor(): The size has been exceeded");
+    return Cursor(this, pos);
+}
+
+template <class T, class Alloc>
+IgushArray<T, Alloc>::Cursor::Cursor(Cursor&& c)
+:_ia(c._ia), _pos(c._pos), _erased(c._erased), _gap(std::move(c._gap))
+{
+    if (_ia && _ia->_pending == &c)
+        _ia->_pending = this;
+    c._ia = 0;
+}
+
+/**
+    The edits are applied to the array. A destructor must not throw,
+    so std::terminate is called if the flush throws: call flush() before to handle the error.
+*/
+template <class T, class Alloc>
+IgushArray<T, Alloc>::Cursor::~Cursor()
+{
+    if (_ia)
+        flush();
+}
+
+/**
+    Returns the element of the array as if the cursor were flushed.
+*/
+template <class T, class Alloc>
+typename IgushArray<T, Alloc>::reference IgushArray<T, Alloc>::Cursor::_element(size_type n)
+{
+    if (n < _pos)
+        return _ia->_element(n);
+    if (n - _pos < _gap.size())
+        return _gap[n - _pos];
+    return _ia->_element(n - _gap.size() + _erased);
+}
+
+/**
+    The array is read through the cursor from its first edit until it is flushed.
+*/
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::Cursor::_hold()
+{
+    if (_ia->_pending && _ia->_pending != this)
+        throw std::logic_error("Cursor: Another cursor has edits");
+    _ia->_pending = this;
+}
+
+/**
+    Erases the element after the cursor.
+*/
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::Cursor::erase()
+{
+    if (_pos + _erased >= _ia->_size())
+        throw std::out_of_range("erase(): The size has been exceeded");
+    _hold();
+    ++_erased;
+}
+
+/**
+    Erases the element before the cursor: the last inserted one or the one before the gap.
+*/
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::Cursor::erase_before()
+{
+    if (!_gap.empty()) {
+        _gap.pop_back();
+        return;
+    }
+    if (!_pos)
+        throw std::out_of_range("erase_before(): Cursor is at the beginning");
+    _hold();
+    --_pos;
+    ++_erased;
+}
+
+/**
+    Flushes the cursor and moves it before the element with the given number.
+*/
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::Cursor::seek(size_type pos)
+{
+    flush();
+    if (pos > _ia->size())
+        throw std::out_of_range("seek(): The size has been exceeded");
+    _pos = pos;
+}
+
+/**
+    Applies the collected insertions and erasures to the array, the DEQs are moved once.
+    The cursor is emptied first, so if the flush throws the exception gets out,
+    the edits which are not applied are lost and the array is valid and not read by the cursor.
+*/
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::Cursor::flush()
+{
+    if (_ia->_pending != this)
+        return;
+    _ia->_pending = 0;
+    size_type erased = _erased;
+    _erased = 0;
+    std::vector<T, Alloc> gap(std::move(_gap));
+    _gap.clear();
+    _ia->_replace(_pos, erased, gap);
+    _pos += gap.size();
+}
+
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::swap(IgushArray<T, Alloc>& ia)
+{
+    assert(!_pending && !ia._pending);
+    std::swap(_capacity, ia._capacity);
+    _v.swap(ia._v);
+    std::swap(_deq_size, ia._deq_size);
+    std::swap(_vec_size, ia._vec_size);
+    std::swap(_storage_mode, ia._storage_mode);
+    std::swap(_sizing_mode, ia._sizing_mode);
+    std::swap(_growth_mode, ia._growth_mode);
+    std::swap(_block_mode, ia._block_mode);
+    std::swap(_cascade_threads, ia._cascade_threads);
+    _counts.swap(ia._counts);
+    std::swap(_deq_shift, ia._deq_shift);
+    std::swap(_deq_mask, ia._deq_mask);
+    _arena.swap(ia._arena);
+    alloc_swap(_a, ia._a);
+}
+
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::clear()
+{
+    assert(!_pending);
+    if (_v.empty())
+        return;
+
+    //Keep the first deque for "end" element
+    for (DeqTVecIter _v_it = _v.begin() + 1; _v_it != _v.end(); ++_v_it)
+        _delete_deque(*_v_it);
+    _v.erase(_v.begin() + 1, _v.end());
+    _v.front().clear();
+    if (_block_mode != FULL) {
+        _counts.reset(_block_mode == FENWICK);
+        _counts.push_back(0);
+    }
+}
+
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::_reserve(size_type n)
+{
+    //Calculate sizes
+    _deq_size = (typename DeqT::size_type) sqrt((double)n);
+    if (!_deq_size)
+        _deq_size = 1;
+
+    //Round to the nearest power of two so the index is decoded by shift and mask
+    _deq_shift = 0;
+    if (_sizing_mode == POW2) {
+        while (((typename DeqT::size_type)2 << _deq_shift) <= _deq_size)
+            ++_deq_shift;
+        typename DeqT::size_type lower = (typename DeqT::size_type)1 << _deq_shift;
+        if (_deq_size - lower > 2*lower - _deq_size)
+            ++_deq_shift;
+        _deq_size = (typename DeqT::size_type)1 << _deq_shift;
+    }
+    _deq_mask = _deq_size - 1;
+    _vec_size = (typename DeqTVec::size_type) ceil((double)n/_deq_size);
+    if (!_vec_size)
+        _vec_size = 1;
+    _capacity = _vec_size*_deq_size;
+
+    //Prepare slabs for all planned deques laid out in their order
+    if (_storage_mode != HEAP)
+        _arena.reset(_deq_size, _vec_size, _storage_mode == HUGE_PAGES);
+
+    //Reserve the directory and create first empty deque for "end" element
+    _v.reserve(_vec_size);
+    _v.push_back(_new_deque());
+    if (_block_mode != FULL) {
+        _counts.reset(_block_mode == FENWICK);
+        _counts.push_back(0);
+    }
+}
+
+/**
+    Leaves the array empty in the default modes with the sizes planned by _reserve(0),
+    but nothing is allocated: the directory is empty and the first DEQ
+    is created when the first element is inserted.
+*/
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::_reset()
+{
+    _v.clear();
+    _capacity = 1;
+    _deq_size = 1;
+    _vec_size = 1;
+    _deq_shift = 0;
+    _deq_mask = 0;
+    _storage_mode = HEAP;
+    _sizing_mode = EXACT;
+    _growth_mode = GEOMETRIC;
+    _block_mode = FULL;
+    _cascade_threads = 1;
+}
+
+/**
+    Calls the function for every block number on the given number of threads,
+    by default on one thread per core. A thread takes the next block as soon as
+    it is done with the previous one, so the threads which got short blocks take more.
+*/
+template <class T, class Alloc>
+template <class BlockFunction>
+void IgushArray<T, Alloc>::_parallel_blocks(BlockFunction f, unsigned threads) const
+{
+    if (!threads)
+        threads = std::thread::hardware_concurrency();
+    if (threads > _v.size())
+        threads = _v.size();
+
+    std::atomic<typename DeqTVec::size_type> next(0);
+    auto work = [this, &f, &next]() {
+        for (typename DeqTVec::size_type vec_n; (vec_n = next++) < _v.size();)
+            f(vec_n);
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned k = 1; k < threads; ++k)
+        workers.push_back(std::thread(work));
+    work();
+    for (typename std::vector<std::thread>::iterator it = workers.begin(); it != workers.end(); ++it)
+        it->join();
+}
+
+/**
+    Returns the totals of the elements of every block. The array must not be empty.
+*/
+template <class T, class Alloc>
+template <class BinaryOperation>
+std::vector<T, Alloc> IgushArray<T, Alloc>::_block_totals(BinaryOperation& op, unsigned threads) const
+{
+    std::vector<T, Alloc> totals(_v.size(), front(), _a);
+    _parallel_blocks([this, &op, &totals](typename DeqTVec::size_type vec_n) {
+        T& total = totals[vec_n];
+        bool first_piece = true;
+        auto piece = [&op, &total, &first_piece](const T* first, size_type n) {
+            const T* last = first + n;
+            if (first_piece) {
+                total = *first++;
+                first_piece = false;
+            }
+            for (; first != last; ++first)
+                total = op(total, *first);
+        };
+        _v[vec_n]._for_pieces(piece);
+    }, threads);
+    return totals;
+}
+
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::_reserve_like(const IgushArray<T, Alloc>& ia, size_type n)
+{
+    //The current structure has been built in the current mode, so drop it first
+    _destroy();
+    _storage_mode = ia._storage_mode;
+    _sizing_mode = ia._sizing_mode;
+    _growth_mode = ia._growth_mode;
+    _block_mode = ia._block_mode;
+    _cascade_threads = ia._cascade_threads;
+    _reserve(n);
+}
+
+/**
+    Builds the copy of the array with the same blocks: every block is copied
+    as a whole and keeps its size and the places of the elements in its ring.
+*/
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::_clone(const IgushArray<T, Alloc>& ia)
+{
+    _capacity = ia._capacity;
+    _deq_size = ia._deq_size;
+    _vec_size = ia._vec_size;
+    _deq_shift = ia._deq_shift;
+    _deq_mask = ia._deq_mask;
+
+    if (_storage_mode != HEAP)
+        _arena.reset(_deq_size, _vec_size, _storage_mode == HUGE_PAGES);
+
+    _v.reserve(std::max(_vec_size, ia._v.size()));
+    for (DeqTVecConstIter vec_it = ia._v.begin(); vec_it != ia._v.end(); ++vec_it) {
+        _v.push_back(_new_deque());
+        _v.back()._copy(*vec_it);
+    }
+    if (_block_mode != FULL)
+        _counts = ia._counts;
+}
+
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::_destroy()
+{
+    _delete_deques();
+    _v.clear();
+}
+
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::_decrease_size(size_type n)
+{
+    if (_block_mode != FULL) {
+        _slack_erase(begin()+n, end());
+        return;
+    }
+
+    typename DeqTVec::size_type vec_size = (typename DeqTVec::size_type) ceil((double)n/_deq_size);
+    if (!vec_size)
+        vec_size = 1;
+    for (DeqTVecIter _v_it = _v.begin()+vec_size; _v_it != _v.end(); ++_v_it)
+        _delete_deque(*_v_it);
+
+    _v.erase(_v.begin()+vec_size, _v.end());
+    _v.back().resize( n - (_v.size()-1)*_deq_size );
+}
+
+template <class T, class Alloc>
+typename IgushArray<T, Alloc>::DeqT IgushArray<T, Alloc>::_new_deque()
+{
+    if (_storage_mode != HEAP)
+        return DeqT(_deq_size, _arena.allocate(), _a);
+    return DeqT(_deq_size, _a);
+}
+
+/**
+    Prepares the deque to be removed from the directory.
+    A deque on the arena storage gives the storage back,
+    a deque on the heap storage frees it itself.
+*/
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::_delete_deque(DeqT& deq)
+{
+    if (_storage_mode != HEAP)
+        _arena.deallocate(deq.release());
+}
+
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::_delete_deques()
+{
+    for (DeqTVecIter _v_it = _v.begin(); _v_it != _v.end(); ++_v_it)
+        _delete_deque(*_v_it);
+}
+
+/**
+    The callers have already re-blocked the array for the new size if it was needed,
+    so the elements are appended block by block with no checks per element.
+*/
+template <class T, class Alloc>
+template <class InputIterator>
+void IgushArray<T, Alloc>::_push_back(InputIterator first, InputIterator last)
+{
+    _push_back(first, last, typename std::iterator_traits<InputIterator>::iterator_category());
+}
+
+template <class T, class Alloc>
+template <class InputIterator>
+void IgushArray<T, Alloc>::_push_back(InputIterator first, InputIterator last, std::random_access_iterator_tag)
+{
+    _push_back(first, last - first);
+}
+
+template <class T, class Alloc>
+template <class InputIterator>
+void IgushArray<T, Alloc>::_push_back(InputIterator first, InputIterator last, std::input_iterator_tag)
+{
+    while (first != last)
+        push_back(*first++);
+}
+
+template <class T, class Alloc>
+template <class InputIterator>
+void IgushArray<T, Alloc>::_push_back(InputIterator& first, size_type n)
+{
+    if (n && _v.empty())
+        _reserve(0);
+    while (n) {
+        if (_v.back().size() == _deq_size) {
+            _v.push_back(_new_deque());
+            if (_block_mode != FULL)
+                _counts.push_back(0);
+        }
+        size_type piece = std::min(n, (size_type)(_deq_size - _v.back().size()));
+        _v.back()._append(first, piece);
+        if (_block_mode != FULL)
+            _counts.add(_v.size() - 1, piece);
+        n -= piece;
+    }
+}
+
+template <class T, class Alloc>
+template <class InputIterator>
+typename IgushArray<T, Alloc>::iterator IgushArray<T, Alloc>::_fill(iterator where, InputIterator first, InputIterator last)
+{
+    while (first != last)
+        *where++ = *first++;
+    return where;
+}
+
+template <class T, class Alloc>
+template <class InputIterator>
+typename IgushArray<T, Alloc>::iterator IgushArray<T, Alloc>::_fill(iterator where, InputIterator& first, size_type n)
+{
+    for (size_type i = 0; i < n; ++i)
+        *where++ = *first++;
+    return where;
+}
+
+
+/**
+    The new element goes to its block if the block has a room,
+    otherwise the block is split into two. Other blocks are not touched.
+*/
+template <class T, class Alloc>
+template <class... Args>
+typename IgushArray<T, Alloc>::iterator IgushArray<T, Alloc>::_slack_emplace(iterator it, Args&&... args)
+{
+    size_type result = it-begin();
+    typename DeqTVec::size_type vec_n = it._vec_it - _v.begin();
+
+    if (it._vec_it->size() < _deq_size) {
+        it._vec_it->emplace(it._deq_it, std::forward<Args>(args)...);
+        _counts.add(vec_n, 1);
+        return begin()+result;
+    }
+
+    //The element is created first since the arguments may refer to an element
+    T val(std::forward<Args>(args)...);
+    if (_grow_needed(size() + 1)) {
+        reserve(2*(size() + 1));
+        return emplace(begin()+result, std::move(val));
+    }
+    _split_insert(vec_n, it._deq_it - it._vec_it->begin(), std::move(val));
+    return begin()+result;
+}
+
+/**
+    The tail of the block is taken away, then the block and new blocks are filled
+    with the new elements and the tail. The new blocks are inserted into the directory
+    at once and only the last filled block may need to be rebalanced.
+*/
+template <class T, class Alloc>
+template <class InputIterator>
+void IgushArray<T, Alloc>::_slack_insert(iterator it, InputIterator first, InputIterator last, size_type n)
+{
+    if (!n)
+        return;
+
+    typename DeqTVec::size_type vec_n = it._vec_it - _v.begin();
+    DeqT tail = _new_deque();
+    for (DeqTIter deq_it = it._deq_it; deq_it != it._vec_it->end(); ++deq_it)
+        tail.push_back(std::move(*deq_it));
+    it._vec_it->erase(it._deq_it, it._vec_it->end());
+
+    DeqTVec new_deques(_v.get_allocator());
+    new_deques.reserve((n + tail.size())/_deq_size + 1);
+    DeqT* deq = &*it._vec_it;
+    for (; first != last; ++first) {
+        if (deq->size() == _deq_size) {
+            new_deques.push_back(_new_deque());
+            deq = &new_deques.back();
+        }
+        deq->push_back(*first);
+    }
+    for (DeqTIter deq_it = tail.begin(); deq_it != tail.end(); ++deq_it) {
+        if (deq->size() == _deq_size) {
+            new_deques.push_back(_new_deque());
+            deq = &new_deques.back();
+        }
+        deq->push_back(std::move(*deq_it));
+    }
+    _delete_deque(tail);
+
+    _v.insert(_v.begin() + vec_n + 1, std::make_move_iterator(new_deques.begin()),
+        std::make_move_iterator(new_deques.end()));
+    _counts.recount(vec_n, _v.begin(), _v.end());
+    _fix(vec_n + new_deques.size());
+}
+
+/**
+    The ends of the range are erased from the first and the last blocks,
+    the blocks between them are removed from the directory at once.
+*/
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::_slack_erase(iterator first, iterator last)
+{
+    if (first >= last)
+        return;
+
+    typename DeqTVec::size_type vec_n = first._vec_it - _v.begin();
+    if (first._vec_it == last._vec_it) {
+        first._vec_it->erase(first._deq_it, last._deq_it);
+        _counts.add(vec_n, first._deq_it - last._deq_it);
+    }
+    else {
+        first._vec_it->erase(first._deq_it, first._vec_it->end());
+        last._vec_it->erase(last._vec_it->begin(), last._deq_it);
+        for (DeqTVecIter vec_it = first._vec_it + 1; vec_it != last._vec_it; ++vec_it)
+            _delete_deque(*vec_it);
+        _v.erase(first._vec_it + 1, last._vec_it);
+        _counts.recount(vec_n, _v.begin(), _v.end());
+    }
+    _fix(vec_n);
+}
+
+/**
+    Splits the full block into two and puts the new element to its place,
+    so both blocks are at least half full.
+*/
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::_split_insert(typename DeqTVec::size_type vec_n, size_type n, T&& val)
+{
+    DeqT right = _new_deque();
+    DeqT& left = _v[vec_n];
+    size_type keep = (_deq_size + 2)/2;
+    size_type from = (n < keep)?keep - 1:keep;
+    for (DeqTIter deq_it = left.begin() + from; deq_it != left.end(); ++deq_it)
+        right.push_back(std::move(*deq_it));
+    left.erase(left.begin() + from, left.end());
+
+    if (n < keep)
+        left.insert(left.begin() + n, std::move(val));
+    else
+        right.insert(right.begin() + (n - keep), std::move(val));
+
+    _v.insert(_v.begin() + vec_n + 1, std::move(right));
+    _counts.recount(vec_n, _v.begin(), _v.end());
+}
+
+/**
+    Restores the slack invariant for the block and the next one:
+    every block but the last is at least half full
+    and the last block is empty only if it is the only one.
+*/
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::_fix(typename DeqTVec::size_type vec_n)
+{
+    while (_v.size() > 1 && _v.back().empty()) {
+        _delete_deque(_v.back());
+        _v.pop_back();
+        _counts.pop_back();
+    }
+
+    while (vec_n + 1 < _v.size() && (_v[vec_n].size() < _min_fill() ||
+        (vec_n + 2 < _v.size() && _v[vec_n + 1].size() < _min_fill())))
+        _rebalance(vec_n);
+}
+
+/**
+    Merges the block with the next one if they fit into one block,
+    otherwise moves elements between them so both are at least half full.
+*/
+template <class T, class Alloc>
+void IgushArray<T, Alloc>::_rebalance(typename DeqTVec::size_type vec_n)
+{
+    DeqT& deq = _v[vec_n];
+    DeqT& next = _v[vec_n + 1];
+
+    if (deq.size() + next.size() <= _deq_size) {
+        for (DeqTIter deq_it = next.begin(); deq_it != next.end(); ++deq_it)
+            deq.push_back(std::move(*deq_it));
+        _delete_deque(next);
+        _v.erase(_v.begin() + vec_n + 1);
+        _counts.recount(vec_n, _v.begin(), _v.end());
+        return;
+    }
+
+    size_type min_fill = _min_fill();
+    difference_type deq_size = deq.size();
+    for (; deq.size() < min_fill; next.pop_front())
+        deq.push_back(std::move(next.front()));
+    for (; next.size() < min_fill; deq.pop_back())
+        next.push_front(std::move(deq.back()));
+    _counts.shift(vec_n, deq_size - (difference_type)deq.size());
+}
+
+//IgushArray whose structure and elements come from a memory resource
+#if __cplusplus >= 201703L && __has_include(<memory_resource>)
+#include <memory_resource>
+#define _IGUSH_ARRAY_PMR
+
+namespace pmr {
+    template <class T>
+    using IgushArray = ::IgushArray<T, std::pmr::polymorphic_allocator<T> >;
+}
+#endif
+
+#endif
@@ -0,0 +1,236 @@
+/**
+    @author Eduard Igushev visit <www.igushev.com> e-mail <eduard@igushev.com>
+    @brief Search and reduction kernels over contiguous segments
+
+    The SegmentKernels class finds, counts, searches the minimum and maximum
+    and sums elements of a plain array. The loops are written so that the compiler
+    vectorizes them for arithmetic types: the search compares a chunk of elements
+    before it checks the result, the minimum and maximum are searched by value first.
+    The kernels keep the results of the standard algorithms, so the floating point
+    minimum and maximum, which may be not a number, are searched element by element.
+
+    On x86 the loops are compiled twice, for the base instruction set (SSE2 on x86-64)
+    and for AVX2, and the AVX2 version is chosen at run time if the processor supports it.
+    Other compilers and processors use the base version only.
+
+    Warranty and license
+    The implementation is provided “as it is” with no warranty.
+    Any private and commercial usage is allowed.
+    Keeping the original name and link to the source is required.
+    Any feedback is welcomed :-)
+*/
+
+#ifndef _SegmentKernels_h
+#define _SegmentKernels_h
+
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define _SEGMENT_KERNELS_AVX2
+#define _SEGMENT_KERNELS_INLINE inline __attribute__((always_inline))
+#define _SEGMENT_KERNELS_TARGET __attribute__((target("avx2")))
+#else
+#define _SEGMENT_KERNELS_INLINE inline
+#endif
+
+template <class T>
+class SegmentKernels {
+
+public:
+
+    typedef size_t size_type;
+
+    static size_type find(const T* p, size_type n, const T& value);
+    static size_type count(const T* p, size_type n, const T& value);
+    static const T* min_element(const T* p, size_type n, const T* least);
+    static const T* max_element(const T* p, size_type n, const T* largest);
+    template <class U>
+    static U accumulate(const T* p, size_type n, U init);
+
+private:
+
+    //The minimum and maximum are searched by value first
+    static const bool _by_value = std::is_integral<T>::value;
+    static T _min_value(const T* p, size_type n, T m);
+    static T _max_value(const T* p, size_type n, T m);
+
+    //Elements compared before the result is checked, a cache line of arithmetic ones
+    static const size_type _chunk = std::is_arithmetic<T>::value?((sizeof(T) < 8)?64/sizeof(T):8):0;
+
+    static _SEGMENT_KERNELS_INLINE size_type _find(const T* p, size_type n, const T& value);
+    static _SEGMENT_KERNELS_INLINE size_type _count(const T* p, size_type n, const T& value);
+    static _SEGMENT_KERNELS_INLINE T _min_loop(const T* p, size_type n, T m);
+    static _SEGMENT_KERNELS_INLINE T _max_loop(const T* p, size_type n, T m);
+    template <class U>
+    static _SEGMENT_KERNELS_INLINE U _accumulate(const T* p, size_type n, U init);
+
+#ifdef _SEGMENT_KERNELS_AVX2
+    static bool _avx2()
+        { static const bool avx2 = __builtin_cpu_supports("avx2"); return avx2; }
+    _SEGMENT_KERNELS_TARGET static size_type _find_avx2(const T* p, size_type n, const T& value)
+        { return _find(p, n, value); }
+    _SEGMENT_KERNELS_TARGET static size_type _count_avx2(const T* p, size_type n, const T& value)
+        { return _count(p, n, value); }
+    _SEGMENT_KERNELS_TARGET static T _min_loop_avx2(const T* p, size_type n, T m)
+        { return _min_loop(p, n, m); }
+    _SEGMENT_KERNELS_TARGET static T _max_loop_avx2(const T* p, size_type n, T m)
+        { return _max_loop(p, n, m); }
+    template <class U>
+    _SEGMENT_KERNELS_TARGET static U _accumulate_avx2(const T* p, size_type n, U init)
+        { return _accumulate(p, n, init); }
+#endif
+};
+
+/**
+    Returns the number of the first element equal to the value or the size if there is none.
+*/
+template <class T>
+typename SegmentKernels<T>::size_type SegmentKernels<T>::find(const T* p, size_type n, const T& value)
+{
+#ifdef _SEGMENT_KERNELS_AVX2
+    if (std::is_arithmetic<T>::value && _avx2())
+        return _find_avx2(p, n, value);
+#endif
+    return _find(p, n, value);
+}
+
+template <class T>
+typename SegmentKernels<T>::size_type SegmentKernels<T>::count(const T* p, size_type n, const T& value)
+{
+#ifdef _SEGMENT_KERNELS_AVX2
+    if (std::is_arithmetic<T>::value && _avx2())
+        return _count_avx2(p, n, value);
+#endif
+    return _count(p, n, value);
+}
+
+/**
+    Returns the first element smaller than the least one found before,
+    or the least one if there is none. The search continues std::min_element
+    over pieces of a range.
+*/
+template <class T>
+const T* SegmentKernels<T>::min_element(const T* p, size_type n, const T* least)
+{
+    if (!_by_value) {
+        for (const T* last = p + n; p != last; ++p)
+            if (*p < *least)
+                least = p;
+        return least;
+    }
+    T m = _min_value(p, n, *least);
+    return (m < *least)?p + find(p, n, m):least;
+}
+
+/**
+    Returns the first element larger than the largest one found before,
+    or the largest one if there is none.
+*/
+template <class T>
+const T* SegmentKernels<T>::max_element(const T* p, size_type n, const T* largest)
+{
+    if (!_by_value) {
+        for (const T* last = p + n; p != last; ++p)
+            if (*largest < *p)
+                largest = p;
+        return largest;
+    }
+    T m = _max_value(p, n, *largest);
+    return (*largest < m)?p + find(p, n, m):largest;
+}
+
+/**
+    Adds the elements to the initial value in their order.
+*/
+template <class T>
+template <class U>
+U SegmentKernels<T>::accumulate(const T* p, size_type n, U init)
+{
+#ifdef _SEGMENT_KERNELS_AVX2
+    if (std::is_arithmetic<T>::value && _avx2())
+        return _accumulate_avx2(p, n, init);
+#endif
+    return _accumulate(p, n, init);
+}
+
+/**
+    Returns the smallest of the elements and the given value.
+*/
+template <class T>
+T SegmentKernels<T>::_min_value(const T* p, size_type n, T m)
+{
+#ifdef _SEGMENT_KERNELS_AVX2
+    if (std::is_arithmetic<T>::value && _avx2())
+        return _min_loop_avx2(p, n, m);
+#endif
+    return _min_loop(p, n, m);
+}
+
+/**
+    Returns the largest of the elements and the given value.
+*/
+template <class T>
+T SegmentKernels<T>::_max_value(const T* p, size_type n, T m)
+{
+#ifdef _SEGMENT_KERNELS_AVX2
+    if (std::is_arithmetic<T>::value && _avx2())
+        return _max_loop_avx2(p, n, m);
+#endif
+    return _max_loop(p, n, m);
+}
+
+template <class T>
+typename SegmentKernels<T>::size_type SegmentKernels<T>::_find(const T* p, size_type n, const T& value)
+{
+    //A whole chunk is compared without a branch, the found one is searched again
+    size_type i = 0;
+    for (; _chunk && i + _chunk <= n; i += _chunk) {
+        bool found = false;
+        for (size_type j = 0; j < _chunk; ++j)
+            found |= (p[i + j] == value);
+        if (found)
+            break;
+    }
+    for (; i < n; ++i)
+        if (p[i] == value)
+            return i;
+    return n;
+}
+
+template <class T>
+typename SegmentKernels<T>::size_type SegmentKernels<T>::_count(const T* p, size_type n, const T& value)
+{
+    size_type c = 0;
+    for (size_type i = 0; i < n; ++i)
+        c += (p[i] == value);
+    return c;
+}
+
+template <class T>
+T SegmentKernels<T>::_min_loop(const T* p, size_type n, T m)
+{
+    for (size_type i = 0; i < n; ++i)
+        m = (p[i] < m)?p[i]:m;
+    return m;
+}
+
+template <class T>
+T SegmentKernels<T>::_max_loop(const T* p, size_type n, T m)
+{
+    for (size_type i = 0; i < n; ++i)
+        m = (m < p[i])?p[i]:m;
+    return m;
+}
+
+template <class T>
+template <class U>
+U SegmentKernels<T>::_accumulate(const T* p, size_type n, U init)
+{
+    for (size_type i = 0; i < n; ++i)
+        init = init + p[i];
+    return init;
+}
+
+#endif
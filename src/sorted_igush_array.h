@@ -0,0 +1,380 @@
+/**
+    @author Eduard Igushev visit <www.igushev.com> e-mail <eduard@igushev.com>
+    @brief Sorted IgushArray
+
+    The SortedIgushArray class keeps the elements of IgushArray sorted
+    and keeps the first element of every DEQ in a plain array of fence keys.
+    An element is searched by the binary search over the fence keys,
+    which gives the DEQ, and then by the binary search in the DEQ.
+    Both arrays are contiguous, so the search takes O(log N) time
+    with about two cache misses instead of O(log N) iterator moves.
+
+    An element is inserted and erased by IgushArray in O(N^1/2) time,
+    and the fence keys of the DEQs after the changed one are copied again,
+    which takes the same O(N^1/2) time.
+
+    Equal elements are kept in the order of their insertion.
+    The elements cannot be changed through iterators.
+
+    The order statistics are answered by the same search: the rank of a value
+    is the number of elements in the DEQs before the found one, which is known
+    from the DEQ directory, plus the position in the DEQ. The k-th element
+    is the element with this number.
+
+    Warranty and license
+    The implementation is provided “as it is” with no warranty.
+    Any private and commercial usage is allowed.
+    Keeping the original name and link to the source is required.
+    Any feedback is welcomed :-)
+*/
+
+#ifndef _SortedIgushArray_h
+#define _SortedIgushArray_h
+
+#include <vector>
+#include <iterator>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <math.h>
+#include "igush_array.h"
+
+template <class T, class Compare = std::less<T>, class Alloc = std::allocator<T> >
+class SortedIgushArray {
+
+    typedef IgushArray<T, Alloc> Array;
+    typedef typename Array::DeqT DeqT;
+    typedef typename Array::Position Position;
+    typedef std::vector<T, Alloc> FenceVec;
+
+public:
+
+    typedef T value_type;
+    typedef Compare key_compare;
+    typedef Compare value_compare;
+    typedef Alloc allocator_type;
+    typedef typename Array::size_type size_type;
+    typedef typename Array::difference_type difference_type;
+    typedef typename Array::const_reference reference;
+    typedef typename Array::const_reference const_reference;
+    typedef typename Array::const_pointer pointer;
+    typedef typename Array::const_pointer const_pointer;
+    typedef typename Array::BlockMode BlockMode;
+
+    //The elements cannot be changed, both iterators are constant
+    typedef typename Array::const_iterator iterator;
+    typedef typename Array::const_iterator const_iterator;
+    typedef typename Array::const_reverse_iterator reverse_iterator;
+    typedef typename Array::const_reverse_iterator const_reverse_iterator;
+
+    explicit SortedIgushArray(const Compare& comp = Compare(), const Alloc& a = Alloc())
+        : _a(a), _fences(a), _comp(comp), _deq_size(0) {}
+    template <class InputIterator>
+    SortedIgushArray(InputIterator first, InputIterator last, const Compare& comp = Compare(), const Alloc& a = Alloc());
+
+    inline bool empty() const
+        { return _a.empty(); }
+    inline size_type size() const
+        { return _a.size(); }
+    inline const Array& array() const
+        { return _a; }
+
+    inline const_iterator begin() const
+        { return _a.begin(); }
+    inline const_iterator end() const
+        { return _a.end(); }
+    inline const_reverse_iterator rbegin() const
+        { return _a.rbegin(); }
+    inline const_reverse_iterator rend() const
+        { return _a.rend(); }
+
+    inline const_reference operator[](size_type n) const
+        { return _a[n]; }
+    inline const_reference at(size_type n) const
+        { return _a.at(n); }
+    inline const_reference front() const
+        { return _a.front(); }
+    inline const_reference back() const
+        { return _a.back(); }
+
+    inline const_iterator lower_bound(const T& value) const
+        { return _iterator(_bound(value, false)); }
+    inline const_iterator upper_bound(const T& value) const
+        { return _iterator(_bound(value, true)); }
+    inline std::pair<const_iterator, const_iterator> equal_range(const T& value) const
+        { return std::make_pair(lower_bound(value), upper_bound(value)); }
+    const_iterator find(const T& value) const;
+    inline size_type count(const T& value) const
+        { return _index(_bound(value, true)) - _index(_bound(value, false)); }
+
+    inline const_reference select(size_type k) const
+        { return _a[k]; }
+    inline const_reference kth_largest(size_type k) const
+        { return _a[size() - 1 - k]; }
+    inline size_type rank(const T& value) const
+        { return _index(_bound(value, false)); }
+    size_type count_in_range(const T& low, const T& high) const;
+    const_reference percentile(double p) const;
+
+    iterator insert(const T& value);
+    iterator insert(T&& value);
+    template <class InputIterator>
+    void insert_sorted(InputIterator first, InputIterator last);
+    iterator erase(const_iterator position);
+    iterator erase(const_iterator first, const_iterator last);
+    size_type erase(const T& value);
+    void clear();
+
+    void reserve(size_type n);
+    inline BlockMode block_mode() const
+        { return _a.block_mode(); }
+    void block_mode(BlockMode block_mode);
+
+    inline key_compare key_comp() const
+        { return _comp; }
+    inline value_compare value_comp() const
+        { return _comp; }
+    void swap(SortedIgushArray<T, Compare, Alloc>&);
+
+private:
+
+    Position _bound(const T& value, bool upper) const;
+    inline const_iterator _iterator(const Position& pos) const
+        { return Array::template _position<const_iterator>(&_a, pos); }
+    inline size_type _index(const Position& pos) const
+        { return _a._before(pos.first) + pos.second; }
+    template <class V>
+    iterator _insert(V&& value);
+    typename Position::first_type _fence_block(const T& value) const;
+    void _refresh(typename Position::first_type vec_n);
+
+    Array _a;
+    //The first element of every not empty DEQ, only the last one can be empty
+    FenceVec _fences;
+    Compare _comp;
+    //The DEQ size the fence keys were taken with
+    size_type _deq_size;
+};
+
+template <class T, class Compare, class Alloc>
+template <class InputIterator>
+SortedIgushArray<T, Compare, Alloc>::SortedIgushArray(InputIterator first, InputIterator last,
+    const Compare& comp, const Alloc& a)
+    : _a(a), _fences(a), _comp(comp), _deq_size(0)
+{
+    std::vector<T, Alloc> elems(first, last, a);
+    std::stable_sort(elems.begin(), elems.end(), _comp);
+    _a.assign(std::make_move_iterator(elems.begin()), std::make_move_iterator(elems.end()));
+    _refresh(0);
+}
+
+template <class T, class Compare, class Alloc>
+typename SortedIgushArray<T, Compare, Alloc>::const_iterator SortedIgushArray<T, Compare, Alloc>::find(const T& value) const
+{
+    const_iterator it = lower_bound(value);
+    return (it == end() || _comp(value, *it))?end():it;
+}
+
+/**
+    Returns the number of elements not less than the low value and less than the high one.
+*/
+template <class T, class Compare, class Alloc>
+typename SortedIgushArray<T, Compare, Alloc>::size_type SortedIgushArray<T, Compare, Alloc>::count_in_range(const T& low, const T& high) const
+{
+    if (!_comp(low, high))
+        return 0;
+    return rank(high) - rank(low);
+}
+
+/**
+    Returns the element of the given percentile from 0 to 100 by the nearest rank:
+    the smallest element which is not less than p percent of the elements.
+*/
+template <class T, class Compare, class Alloc>
+typename SortedIgushArray<T, Compare, Alloc>::const_reference SortedIgushArray<T, Compare, Alloc>::percentile(double p) const
+{
+    if (empty() || !(p >= 0 && p <= 100))
+        throw std::out_of_range("SortedIgushArray::percentile");
+    size_type k = (size_type)ceil(p*size()/100);
+    return _a[k?k - 1:0];
+}
+
+template <class T, class Compare, class Alloc>
+typename SortedIgushArray<T, Compare, Alloc>::iterator SortedIgushArray<T, Compare, Alloc>::insert(const T& value)
+{
+    return _insert(value);
+}
+
+template <class T, class Compare, class Alloc>
+typename SortedIgushArray<T, Compare, Alloc>::iterator SortedIgushArray<T, Compare, Alloc>::insert(T&& value)
+{
+    return _insert(std::move(value));
+}
+
+/**
+    Inserts a batch of elements in O(N + m log m) time, where m is the size of the batch.
+    The batch is sorted and merged with the elements into the array rebuilt for the new size,
+    so every element is moved once. A batch which is smaller than the array
+    divided by the size of a DEQ is inserted element by element, which takes less time.
+*/
+template <class T, class Compare, class Alloc>
+template <class InputIterator>
+void SortedIgushArray<T, Compare, Alloc>::insert_sorted(InputIterator first, InputIterator last)
+{
+    std::vector<T, Alloc> batch(first, last, _a.get_allocator());
+    std::stable_sort(batch.begin(), batch.end(), _comp);
+    if (batch.size()*_a._deq_size < size()) {
+        for (typename std::vector<T, Alloc>::iterator it = batch.begin(); it != batch.end(); ++it)
+            insert(std::move(*it));
+        return;
+    }
+
+    size_type n = std::max(size() + batch.size(), _a.capacity());
+    Array a(_a.get_allocator());
+    a._reserve_like(_a, _a._grow_needed(n)?2*n:n);
+
+    //Equal elements of the batch go after the ones in the array
+    typename std::vector<T, Alloc>::iterator next = batch.begin();
+    auto segment = [this, &a, &batch, &next](T* elem, size_type elem_n) {
+        for (T* elem_last = elem + elem_n; elem != elem_last; ++elem) {
+            for (; next != batch.end() && _comp(*next, *elem); ++next)
+                a.push_back(std::move(*next));
+            a.push_back(std::move(*elem));
+        }
+    };
+    _a.for_each_segment(segment);
+    for (; next != batch.end(); ++next)
+        a.push_back(std::move(*next));
+
+    _a.swap(a);
+    _refresh(0);
+}
+
+template <class T, class Compare, class Alloc>
+typename SortedIgushArray<T, Compare, Alloc>::iterator SortedIgushArray<T, Compare, Alloc>::erase(const_iterator position)
+{
+    return erase(position, position + 1);
+}
+
+template <class T, class Compare, class Alloc>
+typename SortedIgushArray<T, Compare, Alloc>::iterator SortedIgushArray<T, Compare, Alloc>::erase(const_iterator first, const_iterator last)
+{
+    if (first == last)
+        return first;
+
+    typename Position::first_type vec_n = _fence_block(*first);
+    size_type n = first - begin();
+    typename Array::iterator it = _a.begin() + n;
+    _a.erase(it, it + (last - first));
+    _refresh(vec_n);
+    return begin() + n;
+}
+
+template <class T, class Compare, class Alloc>
+typename SortedIgushArray<T, Compare, Alloc>::size_type SortedIgushArray<T, Compare, Alloc>::erase(const T& value)
+{
+    std::pair<const_iterator, const_iterator> range = equal_range(value);
+    size_type n = range.second - range.first;
+    erase(range.first, range.second);
+    return n;
+}
+
+template <class T, class Compare, class Alloc>
+void SortedIgushArray<T, Compare, Alloc>::clear()
+{
+    _a.clear();
+    _refresh(0);
+}
+
+template <class T, class Compare, class Alloc>
+void SortedIgushArray<T, Compare, Alloc>::reserve(size_type n)
+{
+    _a.reserve(n);
+    _refresh(0);
+}
+
+template <class T, class Compare, class Alloc>
+void SortedIgushArray<T, Compare, Alloc>::block_mode(BlockMode block_mode)
+{
+    _a.block_mode(block_mode);
+    _fences.clear();
+    _refresh(0);
+}
+
+template <class T, class Compare, class Alloc>
+void SortedIgushArray<T, Compare, Alloc>::swap(SortedIgushArray<T, Compare, Alloc>& sia)
+{
+    _a.swap(sia._a);
+    _fences.swap(sia._fences);
+    std::swap(_comp, sia._comp);
+    std::swap(_deq_size, sia._deq_size);
+}
+
+/**
+    Returns the position of the first element not less than the value or greater than it.
+    The fence keys give the DEQ after the one which holds the position,
+    the end of a DEQ is turned to the start of the next one.
+*/
+template <class T, class Compare, class Alloc>
+typename SortedIgushArray<T, Compare, Alloc>::Position SortedIgushArray<T, Compare, Alloc>::_bound(const T& value, bool upper) const
+{
+    typename FenceVec::const_iterator fence = upper?
+        std::upper_bound(_fences.begin(), _fences.end(), value, _comp):
+        std::lower_bound(_fences.begin(), _fences.end(), value, _comp);
+    typename Position::first_type vec_n = fence - _fences.begin();
+    if (!vec_n)
+        return Position(0, 0);
+
+    const DeqT& deq = _a._v[--vec_n];
+    size_type deq_n = (upper?
+        std::upper_bound(deq.begin(), deq.end(), value, _comp):
+        std::lower_bound(deq.begin(), deq.end(), value, _comp)) - deq.begin();
+    if (deq_n == deq.size() && vec_n + 1 < _a._v.size())
+        return Position(vec_n + 1, 0);
+    return Position(vec_n, deq_n);
+}
+
+template <class T, class Compare, class Alloc>
+template <class V>
+typename SortedIgushArray<T, Compare, Alloc>::iterator SortedIgushArray<T, Compare, Alloc>::_insert(V&& value)
+{
+    Position pos = _bound(value, true);
+    size_type n = _index(pos);
+    _a.insert(_a.begin() + n, std::forward<V>(value));
+    _refresh(pos.first);
+    return begin() + n;
+}
+
+/**
+    Returns the first DEQ which can hold the value. The elements of the previous DEQs
+    are less than the fence key of the next DEQ and the value.
+*/
+template <class T, class Compare, class Alloc>
+typename SortedIgushArray<T, Compare, Alloc>::Position::first_type SortedIgushArray<T, Compare, Alloc>::_fence_block(const T& value) const
+{
+    typename Position::first_type vec_n = std::lower_bound(_fences.begin(), _fences.end(), value, _comp) - _fences.begin();
+    return vec_n?vec_n - 1:0;
+}
+
+/**
+    Takes the fence keys again from the DEQ before the given one, which may have been
+    merged with the changed one, or from the first DEQ if the DEQs have been rebuilt.
+*/
+template <class T, class Compare, class Alloc>
+void SortedIgushArray<T, Compare, Alloc>::_refresh(typename Position::first_type vec_n)
+{
+    if (_deq_size != _a._deq_size) {
+        _deq_size = _a._deq_size;
+        vec_n = 0;
+    }
+    if (vec_n)
+        --vec_n;
+
+    typename Position::first_type vec_size = _a._v.size() - (!_a._v.empty() && _a._v.back().empty()?1:0);
+    _fences.erase(_fences.begin() + std::min<size_type>(std::min(vec_n, vec_size), _fences.size()), _fences.end());
+    for (typename Position::first_type i = _fences.size(); i < vec_size; ++i)
+        _fences.push_back(_a._v[i].front());
+}
+
+#endif
@@ -0,0 +1,738 @@
+/**
+    @author Eduard Igushev visit <www.igushev.com> e-mail <eduard@igushev.com>
+    @brief Multi-level IgushArray
+
+    The TieredArray class is the generalization of IgushArray to any number of levels.
+    A level is a ring of rings of the level below, the lowest level is FixedDeque.
+    All rings of a level are full except the first and the last one,
+    so the element is found by one division on every level.
+
+    An insertion or an erasure changes the ring of the element on every level
+    and moves one element through the neighbour rings of the same level.
+    A full ring takes an element at one end and gives one away at the other
+    in O(k) time, where k is the number of levels below.
+    Then with the branching factor N^1/k the access takes O(k) time
+    and the insertion/erasure takes O(k^2 * N^1/k) time.
+
+    The array is rebuilt for the doubled size when it gets full.
+
+    The interface is reduced: elements are inserted and erased one by one,
+    there is no range insert or erase, resize, assign or the modes of IgushArray.
+
+    Warranty and license
+    The implementation is provided “as it is” with no warranty.
+    Any private and commercial usage is allowed.
+    Keeping the original name and link to the source is required.
+    Any feedback is welcomed :-)
+*/
+
+#ifndef _TieredArray_h
+#define _TieredArray_h
+
+#include <vector>
+#include <iterator>
+#include <utility>
+#include <stdexcept>
+#include <math.h>
+#include "fixed_deque.h"
+
+/**
+    Ring of the given number of sub-rings, one more slot is kept
+    for both the first and the last sub-rings to be partial.
+*/
+template <class T, class Sub, class Alloc = std::allocator<T> >
+class TieredDeque {
+
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<Sub> SubAlloc;
+    typedef std::vector<Sub, SubAlloc> SubVec;
+
+public:
+
+    typedef typename std::allocator_traits<Alloc>::size_type size_type;
+
+    //The ring with no sub-rings and no room
+    explicit TieredDeque(const Alloc& a) noexcept
+        : _subs(SubAlloc(a)) { _reset(); }
+    TieredDeque(size_type branch, const Alloc& a = Alloc());
+    TieredDeque(TieredDeque<T, Sub, Alloc>&& td) noexcept
+        : _subs(std::move(td._subs)), _branch(td._branch), _sub_size(td._sub_size),
+        _first(td._first), _used(td._used), _size(td._size) { td._reset(); }
+    TieredDeque<T, Sub, Alloc>& operator=(TieredDeque<T, Sub, Alloc>&& td);
+
+    inline bool empty() const
+        { return !_size; }
+    inline size_type size() const
+        { return _size; }
+    inline size_type max_size() const
+        { return _branch*_sub_size; }
+
+    T& operator[](size_type n)
+        { size_type i = _find(n); return _sub(i)[n]; }
+    const T& operator[](size_type n) const
+        { size_type i = _find(n); return _sub(i)[n]; }
+
+    inline T& front()
+        { return _sub(0).front(); }
+    inline const T& front() const
+        { return _sub(0).front(); }
+    inline T& back()
+        { return _sub(_used - 1).back(); }
+    inline const T& back() const
+        { return _sub(_used - 1).back(); }
+
+    void push_back(T&& val);
+    void push_front(T&& val);
+    void pop_back();
+    void pop_front();
+
+    void insert(size_type n, T&& val);
+    void erase(size_type n);
+    void clear();
+    void swap(TieredDeque<T, Sub, Alloc>&);
+
+private:
+
+    TieredDeque(const TieredDeque<T, Sub, Alloc>&);
+    void operator=(const TieredDeque<T, Sub, Alloc>&);
+
+    inline Sub& _sub(size_type i)
+        { i += _first; return _subs[(i < _subs.size())?i:(i - _subs.size())]; }
+    inline const Sub& _sub(size_type i) const
+        { i += _first; return _subs[(i < _subs.size())?i:(i - _subs.size())]; }
+    size_type _find(size_type& n) const;
+    //The ring is left with no sub-rings and no room
+    inline void _reset()
+        { _subs.clear(); _branch = _sub_size = _first = _used = _size = 0; }
+
+    void _carry_front(size_type i, T& carry);
+    void _carry_back(size_type i, T& carry);
+    template <class InputIterator>
+    void _append(InputIterator& first, size_type n);
+
+    template <class InputIterator>
+    static void _append(FixedDeque<T, Alloc>& deq, InputIterator& first, size_type n)
+        { deq._append(first, n); }
+    template <class S, class InputIterator>
+    static void _append(S& sub, InputIterator& first, size_type n)
+        { sub._append(first, n); }
+    static void _insert(FixedDeque<T, Alloc>& deq, size_type n, T&& val)
+        { deq.insert(deq.begin() + n, std::move(val)); }
+    template <class S>
+    static void _insert(S& sub, size_type n, T&& val)
+        { sub.insert(n, std::move(val)); }
+    static void _erase(FixedDeque<T, Alloc>& deq, size_type n)
+        { deq.erase(deq.begin() + n); }
+    template <class S>
+    static void _erase(S& sub, size_type n)
+        { sub.erase(n); }
+
+    SubVec _subs;
+    size_type _branch;
+    size_type _sub_size;
+    size_type _first;
+    size_type _used;
+    size_type _size;
+
+    template <class, class, class> friend class TieredDeque;
+    template <class, unsigned, class> friend class TieredArray;
+};
+
+/**
+    Type of the ring of the given level
+*/
+template <class T, unsigned Levels, class Alloc>
+struct TieredNode {
+    typedef TieredDeque<T, typename TieredNode<T, Levels - 1, Alloc>::type, Alloc> type;
+};
+
+template <class T, class Alloc>
+struct TieredNode<T, 1, Alloc> {
+    typedef FixedDeque<T, Alloc> type;
+};
+
+template <class T, unsigned Levels = 3, class Alloc = std::allocator<T> >
+class TieredArray {
+
+    static_assert(Levels >= 2, "TieredArray needs at least two levels");
+
+    typedef typename TieredNode<T, Levels, Alloc>::type Node;
+
+    typedef TieredArray<T, Levels, Alloc>* TieredArrayTPtr;
+    typedef const TieredArray<T, Levels, Alloc>* TieredArrayTConstPtr;
+
+public:
+
+    typedef Alloc allocator_type;
+
+    typedef typename std::allocator_traits<Alloc>::size_type size_type;
+    typedef typename std::allocator_traits<Alloc>::difference_type difference_type;
+    typedef T value_type;
+
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef typename std::allocator_traits<Alloc>::pointer pointer;
+    typedef typename std::allocator_traits<Alloc>::const_pointer const_pointer;
+
+    template <class U, class TieredArrayPtr>
+    class TieredArrayIterator {
+
+        typedef TieredArrayIterator<U, TieredArrayPtr> Self;
+        typedef TieredArrayIterator<const T, TieredArrayTConstPtr> SelfConst;
+
+        TieredArrayIterator(TieredArrayPtr ta, size_type n)
+            :_ta(ta), _n(n) {}
+
+    public:
+
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+        typedef U value_type;
+        typedef U& reference;
+        typedef U* pointer;
+
+        TieredArrayIterator()
+            :_ta(0), _n(0) {}
+
+        inline Self& operator++()
+            { ++_n; return *this; }
+        inline Self operator++(int)
+            { Self temp = *this; ++*this; return temp; }
+        inline Self& operator--()
+            { --_n; return *this; }
+        inline Self operator--(int)
+            { Self temp = *this; --*this; return temp; }
+
+        inline Self& operator+=(difference_type incr)
+            { _n += incr; return *this; }
+        inline Self operator+(difference_type incr) const
+            { Self temp = *this; temp += incr; return temp; }
+        inline Self& operator-=(difference_type decr)
+            { _n -= decr; return *this; }
+        inline Self operator-(difference_type decr) const
+            { Self temp = *this; temp -= decr; return temp; }
+
+        inline difference_type operator-(const Self& tai) const
+            { return (difference_type)_n - (difference_type)tai._n; }
+
+        inline U& operator*() const
+            { return (*_ta)[_n]; }
+        inline U* operator->() const
+            { return &(*_ta)[_n]; }
+        inline U& operator[](difference_type n) const
+            { return *(*this + n); }
+        friend inline Self operator+(difference_type n, const Self& it)
+            { return it + n; }
+
+        inline bool operator==(const Self& tai) const
+            { return _n == tai._n; }
+        inline bool operator!=(const Self& tai) const
+            { return !(*this == tai); }
+        inline bool operator<(const Self& tai) const
+            { return _n < tai._n; }
+        inline bool operator<=(const Self& tai) const
+            { return _n <= tai._n; }
+        inline bool operator>(const Self& tai) const
+            { return _n > tai._n; }
+        inline bool operator>=(const Self& tai) const
+            { return _n >= tai._n; }
+
+        inline operator SelfConst() const
+            { return SelfConst(_ta, _n); }
+
+    private:
+
+        TieredArrayPtr _ta;
+        size_type _n;
+
+        friend class TieredArray<T, Levels, Alloc>;
+    };
+
+    typedef TieredArrayIterator<T, TieredArrayTPtr> iterator;
+    typedef TieredArrayIterator<const T, TieredArrayTConstPtr> const_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+
+    //The array has no rings until the first insertion builds them
+    explicit TieredArray(const Alloc& a = Alloc()) noexcept
+        : _top(a), _a(a) {}
+    explicit TieredArray(size_type n, const T& value = T(), const Alloc& a = Alloc());
+    TieredArray(const TieredArray<T, Levels, Alloc>& ta)
+        : TieredArray(ta, std::allocator_traits<Alloc>::select_on_container_copy_construction(ta._a)) {}
+    TieredArray(const TieredArray<T, Levels, Alloc>& ta, const Alloc& a);
+    //The moved-from array is left with no rings as the default one
+    TieredArray(TieredArray<T, Levels, Alloc>&& ta) noexcept
+        : _top(std::move(ta._top)), _a(ta._a) {}
+    TieredArray<T, Levels, Alloc>& operator=(const TieredArray<T, Levels, Alloc>& ta);
+    TieredArray<T, Levels, Alloc>& operator=(TieredArray<T, Levels, Alloc>&& ta)
+        noexcept(std::allocator_traits<Alloc>::propagate_on_container_move_assignment::value ||
+            std::allocator_traits<Alloc>::is_always_equal::value);
+
+    inline bool empty() const
+        { return _top.empty(); }
+    inline size_type size() const
+        { return _top.size(); }
+    inline size_type capacity() const
+        { return _top.max_size(); }
+    void reserve(size_type n);
+
+    inline iterator begin()
+        { return iterator(this, 0); }
+    inline const_iterator begin() const
+        { return const_iterator(this, 0); }
+    inline iterator end()
+        { return iterator(this, size()); }
+    inline const_iterator end() const
+        { return const_iterator(this, size()); }
+
+    inline reverse_iterator rbegin()
+        { return reverse_iterator(end()); }
+    inline const_reverse_iterator rbegin() const
+        { return const_reverse_iterator(end()); }
+    inline reverse_iterator rend()
+        { return reverse_iterator(begin()); }
+    inline const_reverse_iterator rend() const
+        { return const_reverse_iterator(begin()); }
+
+    inline reference operator[](size_type n)
+        { return _top[n]; }
+    inline const_reference operator[](size_type n) const
+        { return _top[n]; }
+    reference at(size_type n);
+    const_reference at(size_type n) const;
+
+    inline reference front()
+        { return _top.front(); }
+    inline const_reference front() const
+        { return _top.front(); }
+    inline reference back()
+        { return _top.back(); }
+    inline const_reference back() const
+        { return _top.back(); }
+
+    //The new element is taken out first since it may refer to an element
+    inline void push_back(const T& val)
+        { push_back(T(val)); }
+    void push_back(T&& val);
+    inline void pop_back()
+        { _top.pop_back(); }
+
+    inline iterator insert(iterator it, const T& val)
+        { return insert(it, T(val)); }
+    iterator insert(iterator it, T&& val);
+    iterator erase(iterator it);
+
+    void swap(TieredArray<T, Levels, Alloc>&);
+    inline void clear()
+        { _top.clear(); }
+    inline Alloc get_allocator()
+        { return _a; }
+
+private:
+
+    static size_type _branch(size_type n);
+    void _grow();
+
+    Node _top;
+    Alloc _a;
+};
+
+template <class T, class Sub, class Alloc>
+TieredDeque<T, Sub, Alloc>::TieredDeque(size_type branch, const Alloc& a)
+: _subs(SubAlloc(a)), _branch(branch), _first(0), _used(0), _size(0)
+{
+    _subs.reserve(branch + 1);
+    for (size_type i = 0; i <= branch; ++i)
+        _subs.push_back(Sub(branch, a));
+    _sub_size = _subs.front().max_size();
+}
+
+/**
+    The sub-rings are taken from the given ring, which is left with none.
+    The allocators have to be equal unless the allocator propagates.
+*/
+template <class T, class Sub, class Alloc>
+TieredDeque<T, Sub, Alloc>& TieredDeque<T, Sub, Alloc>::operator=(TieredDeque<T, Sub, Alloc>&& td)
+{
+    if (this == &td)
+        return *this;
+
+    _subs = std::move(td._subs);
+    _branch = td._branch;
+    _sub_size = td._sub_size;
+    _first = td._first;
+    _used = td._used;
+    _size = td._size;
+    td._reset();
+    return *this;
+}
+
+template <class T, class Sub, class Alloc>
+void TieredDeque<T, Sub, Alloc>::push_back(T&& val)
+{
+    if (!_used || _sub(_used - 1).size() == _sub_size)
+        ++_used;
+    _sub(_used - 1).push_back(std::move(val));
+    ++_size;
+}
+
+template <class T, class Sub, class Alloc>
+void TieredDeque<T, Sub, Alloc>::push_front(T&& val)
+{
+    if (!_used || _sub(0).size() == _sub_size) {
+        _first = (_first?_first:_subs.size()) - 1;
+        ++_used;
+    }
+    _sub(0).push_front(std::move(val));
+    ++_size;
+}
+
+template <class T, class Sub, class Alloc>
+void TieredDeque<T, Sub, Alloc>::pop_back()
+{
+    Sub& sub = _sub(_used - 1);
+    sub.pop_back();
+    --_size;
+    if (sub.empty())
+        --_used;
+}
+
+template <class T, class Sub, class Alloc>
+void TieredDeque<T, Sub, Alloc>::pop_front()
+{
+    Sub& sub = _sub(0);
+    sub.pop_front();
+    --_size;
+    if (sub.empty()) {
+        _first = (_first + 1 < _subs.size())?_first + 1:0;
+        --_used;
+    }
+}
+
+/**
+    The ring has to have a room. The new element is inserted into its sub-ring
+    and the element pushed out of it is carried to the nearer end of the ring.
+*/
+template <class T, class Sub, class Alloc>
+void TieredDeque<T, Sub, Alloc>::insert(size_type n, T&& val)
+{
+    if (n == _size) {
+        push_back(std::move(val));
+        return;
+    }
+    if (!n) {
+        push_front(std::move(val));
+        return;
+    }
+
+    size_type i = _find(n);
+    Sub& sub = _sub(i);
+    if (sub.size() < _sub_size) {
+        _insert(sub, n, std::move(val));
+        ++_size;
+        return;
+    }
+
+    if (i < _used - i) {
+        if (!n) {
+            _carry_front(i, val);
+            return;
+        }
+        T carry(std::move(sub.front()));
+        sub.pop_front();
+        _insert(sub, n - 1, std::move(val));
+        _carry_front(i, carry);
+    }
+    else {
+        T carry(std::move(sub.back()));
+        sub.pop_back();
+        _insert(sub, n, std::move(val));
+        _carry_back(i, carry);
+    }
+}
+
+/**
+    The element is erased from its sub-ring
+    and the gap is filled from the nearer end of the ring.
+*/
+template <class T, class Sub, class Alloc>
+void TieredDeque<T, Sub, Alloc>::erase(size_type n)
+{
+    size_type i = _find(n);
+    _erase(_sub(i), n);
+    --_size;
+
+    if (i < _used - i) {
+        for (; i; --i) {
+            Sub& prev = _sub(i - 1);
+            _sub(i).push_front(std::move(prev.back()));
+            prev.pop_back();
+        }
+        if (_sub(0).empty()) {
+            _first = (_first + 1 < _subs.size())?_first + 1:0;
+            --_used;
+        }
+    }
+    else {
+        for (; i + 1 < _used; ++i) {
+            Sub& next = _sub(i + 1);
+            _sub(i).push_back(std::move(next.front()));
+            next.pop_front();
+        }
+        if (_sub(_used - 1).empty())
+            --_used;
+    }
+}
+
+template <class T, class Sub, class Alloc>
+void TieredDeque<T, Sub, Alloc>::clear()
+{
+    for (size_type i = 0; i < _used; ++i)
+        _sub(i).clear();
+    _first = _used = _size = 0;
+}
+
+template <class T, class Sub, class Alloc>
+void TieredDeque<T, Sub, Alloc>::swap(TieredDeque<T, Sub, Alloc>& td)
+{
+    _subs.swap(td._subs);
+    std::swap(_branch, td._branch);
+    std::swap(_sub_size, td._sub_size);
+    std::swap(_first, td._first);
+    std::swap(_used, td._used);
+    std::swap(_size, td._size);
+}
+
+/**
+    Returns the sub-ring of the element and the number of the element in it.
+    Only the first sub-ring can be partial before the element.
+*/
+template <class T, class Sub, class Alloc>
+typename TieredDeque<T, Sub, Alloc>::size_type TieredDeque<T, Sub, Alloc>::_find(size_type& n) const
+{
+    size_type first_size = _sub(0).size();
+    if (n < first_size)
+        return 0;
+
+    n -= first_size;
+    size_type i = n/_sub_size;
+    n -= i*_sub_size;
+    return i + 1;
+}
+
+template <class T, class Sub, class Alloc>
+void TieredDeque<T, Sub, Alloc>::_carry_front(size_type i, T& carry)
+{
+    //Full sub-rings are turned by one element
+    while (i--) {
+        Sub& sub = _sub(i);
+        if (sub.size() < _sub_size) {
+            sub.push_back(std::move(carry));
+            ++_size;
+            return;
+        }
+        T out(std::move(sub.front()));
+        sub.pop_front();
+        sub.push_back(std::move(carry));
+        carry = std::move(out);
+    }
+
+    _first = (_first?_first:_subs.size()) - 1;
+    ++_used;
+    _sub(0).push_back(std::move(carry));
+    ++_size;
+}
+
+template <class T, class Sub, class Alloc>
+void TieredDeque<T, Sub, Alloc>::_carry_back(size_type i, T& carry)
+{
+    while (++i < _used) {
+        Sub& sub = _sub(i);
+        if (sub.size() < _sub_size) {
+            sub.push_front(std::move(carry));
+            ++_size;
+            return;
+        }
+        T out(std::move(sub.back()));
+        sub.pop_back();
+        sub.push_front(std::move(carry));
+        carry = std::move(out);
+    }
+
+    ++_used;
+    _sub(_used - 1).push_back(std::move(carry));
+    ++_size;
+}
+
+/**
+    Constructs n elements at the back without checks, the ring must have a room for them.
+    The sub-rings are filled in order, each one by a single append on the level below.
+*/
+template <class T, class Sub, class Alloc>
+template <class InputIterator>
+void TieredDeque<T, Sub, Alloc>::_append(InputIterator& first, size_type n)
+{
+    while (n) {
+        if (!_used || _sub(_used - 1).size() == _sub_size)
+            ++_used;
+        Sub& sub = _sub(_used - 1);
+        size_type piece = std::min(n, _sub_size - sub.size());
+        _append(sub, first, piece);
+        _size += piece;
+        n -= piece;
+    }
+}
+
+template <class T, unsigned Levels, class Alloc>
+TieredArray<T, Levels, Alloc>::TieredArray(size_type n, const T& value, const Alloc& a)
+: _top(a), _a(a)
+{
+    reserve(n);
+    for (size_type i = 0; i < n; ++i)
+        push_back(value);
+}
+
+/**
+    The copy of the array whose rings and elements are allocated by the given allocator.
+*/
+template <class T, unsigned Levels, class Alloc>
+TieredArray<T, Levels, Alloc>::TieredArray(const TieredArray<T, Levels, Alloc>& ta, const Alloc& a)
+: _top(a), _a(a)
+{
+    reserve(ta.capacity());
+    const_iterator first = ta.begin();
+    _top._append(first, ta.size());
+}
+
+/**
+    The allocator is taken with the copy only if it propagates on both copy assignment and swap.
+*/
+template <class T, unsigned Levels, class Alloc>
+TieredArray<T, Levels, Alloc>& TieredArray<T, Levels, Alloc>::operator=(const TieredArray<T, Levels, Alloc>& ta)
+{
+    bool propagate = std::allocator_traits<Alloc>::propagate_on_container_copy_assignment::value &&
+        std::allocator_traits<Alloc>::propagate_on_container_swap::value;
+    TieredArray<T, Levels, Alloc>(ta, propagate?ta._a:_a).swap(*this);
+    return *this;
+}
+
+/**
+    The rings are taken if the allocators are equal or the allocator propagates,
+    the given array is left as by the move constructor.
+    Otherwise the elements are moved to rings allocated by the own allocator.
+*/
+template <class T, unsigned Levels, class Alloc>
+TieredArray<T, Levels, Alloc>& TieredArray<T, Levels, Alloc>::operator=(TieredArray<T, Levels, Alloc>&& ta)
+    noexcept(std::allocator_traits<Alloc>::propagate_on_container_move_assignment::value ||
+        std::allocator_traits<Alloc>::is_always_equal::value)
+{
+    if (this == &ta)
+        return *this;
+
+    if (std::allocator_traits<Alloc>::propagate_on_container_move_assignment::value || _a == ta._a) {
+        _top = std::move(ta._top);
+        alloc_move_assign(_a, ta._a);
+        return *this;
+    }
+    TieredArray<T, Levels, Alloc> moved(_a);
+    moved.reserve(ta.size());
+    for (iterator it = ta.begin(); it != ta.end(); ++it)
+        moved.push_back(std::move(*it));
+    swap(moved);
+    ta.clear();
+    return *this;
+}
+
+template <class T, unsigned Levels, class Alloc>
+void TieredArray<T, Levels, Alloc>::reserve(size_type n)
+{
+    if (n <= capacity())
+        return;
+
+    TieredArray<T, Levels, Alloc> ta(_a);
+    Node top(_branch(n), _a);
+    ta._top.swap(top);
+    std::move_iterator<iterator> first(begin());
+    ta._top._append(first, size());
+    swap(ta);
+}
+
+template <class T, unsigned Levels, class Alloc>
+typename TieredArray<T, Levels, Alloc>::reference TieredArray<T, Levels, Alloc>::at(size_type n)
+{
+    if (n >= size())
+        throw std::out_of_range("at(): The size has been exceeded");
+    return _top[n];
+}
+
+template <class T, unsigned Levels, class Alloc>
+typename TieredArray<T, Levels, Alloc>::const_reference TieredArray<T, Levels, Alloc>::at(size_type n) const
+{
+    if (n >= size())
+        throw std::out_of_range("at(): The size has been exceeded");
+    return _top[n];
+}
+
+template <class T, unsigned Levels, class Alloc>
+void TieredArray<T, Levels, Alloc>::push_back(T&& val)
+{
+    T temp(std::move(val));
+    if (size() == capacity())
+        _grow();
+    _top.push_back(std::move(temp));
+}
+
+template <class T, unsigned Levels, class Alloc>
+typename TieredArray<T, Levels, Alloc>::iterator TieredArray<T, Levels, Alloc>::insert(iterator it, T&& val)
+{
+    size_type n = it._n;
+    T temp(std::move(val));
+    if (size() == capacity())
+        _grow();
+    _top.insert(n, std::move(temp));
+    return iterator(this, n);
+}
+
+template <class T, unsigned Levels, class Alloc>
+typename TieredArray<T, Levels, Alloc>::iterator TieredArray<T, Levels, Alloc>::erase(iterator it)
+{
+    _top.erase(it._n);
+    return it;
+}
+
+template <class T, unsigned Levels, class Alloc>
+void TieredArray<T, Levels, Alloc>::swap(TieredArray<T, Levels, Alloc>& ta)
+{
+    _top.swap(ta._top);
+    alloc_swap(_a, ta._a);
+}
+
+/**
+    Returns the branching factor for the given capacity, not less than 2
+*/
+template <class T, unsigned Levels, class Alloc>
+typename TieredArray<T, Levels, Alloc>::size_type TieredArray<T, Levels, Alloc>::_branch(size_type n)
+{
+    size_type branch = (size_type) pow((double)n, 1.0/Levels);
+    if (branch < 2)
+        branch = 2;
+
+    for (;; ++branch) {
+        size_type capacity = 1;
+        for (unsigned level = 0; level < Levels; ++level)
+            capacity *= branch;
+        if (capacity >= n)
+            return branch;
+    }
+}
+
+/**
+    Rebuilds the array for the doubled size, an array with no rings gets its first ones
+*/
+template <class T, unsigned Levels, class Alloc>
+void TieredArray<T, Levels, Alloc>::_grow()
+{
+    reserve(size()?2*size():1);
+}
+
+#endif
@@ -75,6 +75,20 @@ private:
         void Execute() const;
     };
 
+    class MoveOnlyElements : public Test {
+    public:
+        MoveOnlyElements(FixedDequeStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Move only elements"; }
+        void Execute() const;
+    };
+
+    class TriviallyCopyable : public Test {
+    public:
+        TriviallyCopyable(FixedDequeStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Trivially copyable elements"; }
+        void Execute() const;
+    };
+
     class Iterators : public Test {
     public:
         Iterators(FixedDequeStabTestPack* test_pack):Test(test_pack) {}
@@ -14,7 +14,12 @@
 
 #include "perf_test_pack.h"
 #include "igush_array.h"
+#include "tiered_array.h"
 #include <vector>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <functional>
 
 class IgushArrayPerfTestPack : public PerfTestPack {
 public:
@@ -27,13 +32,31 @@ private:
     typedef IgushArray<TypeTest> IgushArrayTest;
     typedef std::vector<TypeBaseline> VectorBaseline;
 
+    //Same as TestType, but the copy constructor hides it is trivial
+    class TypeNotTrivial {
+    public:
+        TypeNotTrivial(TestType i = 0):_i(i) {}
+        TypeNotTrivial(const TypeNotTrivial& obj):_i(obj._i) {}
+        operator TestType() const { return _i; }
+    private:
+        TestType _i;
+    };
+
+    typedef IgushArray<TestType> IgushArrayTrivial;
+    typedef IgushArray<TypeNotTrivial> IgushArrayNotTrivial;
+    typedef TieredArray<TestType, 2> TieredArray2;
+    typedef TieredArray<TestType, 3> TieredArray3;
+#ifdef _IGUSH_ARRAY_PMR
+    typedef ::pmr::IgushArray<TestType> IgushArrayPmr;
+#endif
+
+    //A test measures the containers it has Execute for, the comparisons call them
+    //on the type of the test, so a container the test does not measure is not compiled
     class Test {
     public:
         Test(IgushArrayPerfTestPack* test_pack):_test_pack(test_pack), _finished(false) {}
         virtual std::string TestName() const = 0;
         virtual void PrintDims() const = 0;
-        virtual Measure Execute(IgushArrayTest&) const = 0;
-        virtual Measure Execute(VectorBaseline&) const = 0;
         virtual void Next() = 0;
         bool Finished() const { return _finished; }
     protected:
@@ -74,6 +97,8 @@ private:
         std::string Dim1Name() const { return "Size"; }
         Measure Execute(IgushArrayTest& container) const { return ExecuteBody(container); }
         Measure Execute(VectorBaseline& container) const { return ExecuteBody(container); }
+        Measure Execute(TieredArray2& container) const { return ExecuteBody(container); }
+        Measure Execute(TieredArray3& container) const { return ExecuteBody(container); }
     private:
         template <class Cont>
         Measure ExecuteBody(Cont& container) const
@@ -81,13 +106,44 @@ private:
             unsigned count = _dim1;
             IgushArrayPerfTestPack::_push_back_reserve<Cont>(container, count);
             Measure measure;
+            unsigned long sum = 0;
             measure.start();
             for (unsigned test = 0; test < IgushArrayPerfTestPack::_test_iterations; ++test) {
-                TestType sum = 0;
                 for (unsigned i = 0; i < count; ++i)
                     sum += container[i];
             }
             measure.stop();
+            IgushArrayPerfTestPack::_sink = sum;
+            return measure;
+        }
+    };
+
+    class AccessByRandomNumber : public Test1Dim {
+    public:
+        AccessByRandomNumber(IgushArrayPerfTestPack* test_pack):Test1Dim(test_pack) {}
+        std::string TestName() const { return "Accessing elements by random numbers"; }
+        std::string Dim1Name() const { return "Size"; }
+        Measure Execute(IgushArrayTest& container) const { return ExecuteBody(container); }
+        Measure Execute(VectorBaseline& container) const { return ExecuteBody(container); }
+    private:
+        template <class Cont>
+        Measure ExecuteBody(Cont& container) const
+        {
+            unsigned count = _dim1;
+            IgushArrayPerfTestPack::_push_back_reserve<Cont>(container, count);
+            std::vector<unsigned> numbers(count);
+            for (unsigned i = 0; i < count; ++i)
+                numbers[i] = i;
+            std::shuffle(numbers.begin(), numbers.end(), std::mt19937());
+            Measure measure;
+            unsigned long sum = 0;
+            measure.start();
+            for (unsigned test = 0; test < IgushArrayPerfTestPack::_test_iterations/100; ++test) {
+                for (unsigned i = 0; i < count; ++i)
+                    sum += container[numbers[i]];
+            }
+            measure.stop();
+            IgushArrayPerfTestPack::_sink = sum;
             return measure;
         }
     };
@@ -106,13 +162,99 @@ private:
             unsigned count = _dim1;
             IgushArrayPerfTestPack::_push_back_reserve<Cont>(container, count);
             Measure measure;
+            unsigned long sum = 0;
             measure.start();
             for (unsigned test = 0; test < IgushArrayPerfTestPack::_test_iterations; ++test) {
-                TestType sum = 0;
                 for (typename Cont::iterator it = container.begin(); it != container.end(); ++it)
                     sum += *it;
             }
             measure.stop();
+            IgushArrayPerfTestPack::_sink = sum;
+            return measure;
+        }
+    };
+
+    class AccessBySegment : public Test1Dim {
+    public:
+        AccessBySegment(IgushArrayPerfTestPack* test_pack):Test1Dim(test_pack) {}
+        std::string TestName() const { return "Accessing elements by contiguous segments"; }
+        std::string Dim1Name() const { return "Size"; }
+        Measure Execute(IgushArrayTest& container) const
+        {
+            unsigned count = _dim1;
+            IgushArrayPerfTestPack::_push_back_reserve<IgushArrayTest>(container, count);
+            Measure measure;
+            unsigned long sum = 0;
+            auto segment = [&sum](const TypeTest* first, size_t n) {
+                for (const TypeTest* last = first + n; first != last; ++first)
+                    sum += *first;
+            };
+            measure.start();
+            for (unsigned test = 0; test < IgushArrayPerfTestPack::_test_iterations; ++test)
+                container.for_each_segment(segment);
+            measure.stop();
+            IgushArrayPerfTestPack::_sink = sum;
+            return measure;
+        }
+        Measure Execute(VectorBaseline& container) const
+        {
+            unsigned count = _dim1;
+            IgushArrayPerfTestPack::_push_back_reserve<VectorBaseline>(container, count);
+            Measure measure;
+            unsigned long sum = 0;
+            measure.start();
+            for (unsigned test = 0; test < IgushArrayPerfTestPack::_test_iterations; ++test) {
+                for (const TypeBaseline* it = container.data(), *last = it + container.size(); it != last; ++it)
+                    sum += *it;
+            }
+            measure.stop();
+            IgushArrayPerfTestPack::_sink = sum;
+            return measure;
+        }
+    };
+
+    class FindKernel : public Test1Dim {
+    public:
+        FindKernel(IgushArrayPerfTestPack* test_pack):Test1Dim(test_pack) {}
+        std::string TestName() const { return "Finding an absent element"; }
+        std::string Dim1Name() const { return "Size"; }
+        Measure Execute(IgushArrayTrivial& container) const { return ExecuteBody(container, false); }
+        Measure ExecuteKernels(IgushArrayTrivial& container) const { return ExecuteBody(container, true); }
+    private:
+        Measure ExecuteBody(IgushArrayTrivial& container, bool kernels) const
+        {
+            unsigned count = _dim1;
+            IgushArrayPerfTestPack::_push_back_reserve<IgushArrayTrivial>(container, count);
+            Measure measure;
+            unsigned long sum = 0;
+            measure.start();
+            for (unsigned test = 0; test < IgushArrayPerfTestPack::_test_iterations; ++test)
+                sum += (kernels?container.find(-1):std::find(container.begin(), container.end(), -1)) - container.begin();
+            measure.stop();
+            IgushArrayPerfTestPack::_sink = sum;
+            return measure;
+        }
+    };
+
+    class AccumulateKernel : public Test1Dim {
+    public:
+        AccumulateKernel(IgushArrayPerfTestPack* test_pack):Test1Dim(test_pack) {}
+        std::string TestName() const { return "Summing elements"; }
+        std::string Dim1Name() const { return "Size"; }
+        Measure Execute(IgushArrayTrivial& container) const { return ExecuteBody(container, false); }
+        Measure ExecuteKernels(IgushArrayTrivial& container) const { return ExecuteBody(container, true); }
+    private:
+        Measure ExecuteBody(IgushArrayTrivial& container, bool kernels) const
+        {
+            unsigned count = _dim1;
+            IgushArrayPerfTestPack::_push_back_reserve<IgushArrayTrivial>(container, count);
+            Measure measure;
+            unsigned long sum = 0;
+            measure.start();
+            for (unsigned test = 0; test < IgushArrayPerfTestPack::_test_iterations; ++test)
+                sum += kernels?container.accumulate(0UL):std::accumulate(container.begin(), container.end(), 0UL);
+            measure.stop();
+            IgushArrayPerfTestPack::_sink = sum;
             return measure;
         }
     };
@@ -124,6 +266,10 @@ private:
         std::string Dim1Name() const { return "Size"; }
         Measure Execute(IgushArrayTest& container) const { return ExecuteBody(container); }
         Measure Execute(VectorBaseline& container) const { return ExecuteBody(container); }
+        Measure Execute(IgushArrayTrivial& container) const { return ExecuteBody(container); }
+        Measure Execute(IgushArrayNotTrivial& container) const { return ExecuteBody(container); }
+        Measure Execute(TieredArray2& container) const { return ExecuteBody(container); }
+        Measure Execute(TieredArray3& container) const { return ExecuteBody(container); }
     private:
         template <class Cont>
         Measure ExecuteBody(Cont& container) const
@@ -143,6 +289,35 @@ private:
         }
     };
 
+    class InsertOneNoReserve : public Test1Dim {
+    public:
+        InsertOneNoReserve(IgushArrayPerfTestPack* test_pack):Test1Dim(test_pack) {}
+        std::string TestName() const { return "Inserting and erasing one element in the middle without reserve"; }
+        std::string Dim1Name() const { return "Size"; }
+        Measure Execute(IgushArrayTest& container) const { return ExecuteBody(container); }
+        Measure Execute(VectorBaseline& container) const { return ExecuteBody(container); }
+        Measure Execute(IgushArrayTrivial& container) const { return ExecuteBody(container); }
+#ifdef _IGUSH_ARRAY_PMR
+        Measure Execute(IgushArrayPmr& container) const { return ExecuteBody(container); }
+#endif
+    private:
+        template <class Cont>
+        Measure ExecuteBody(Cont& container) const
+        {
+            unsigned count = _dim1;
+            IgushArrayPerfTestPack::_push_back<Cont>(container, count - 1);
+            Measure measure;
+            measure.start();
+            for (unsigned test = 0; test < IgushArrayPerfTestPack::_test_iterations; ++test) {
+                typename Cont::iterator it =
+                    container.insert(container.begin() + container.size()/2, TestType());
+                container.erase(it);
+            }
+            measure.stop();
+            return measure;
+        }
+    };
+
     class EraseOne : public Test1Dim {
     public:
         EraseOne(IgushArrayPerfTestPack* test_pack):Test1Dim(test_pack) {}
@@ -150,6 +325,8 @@ private:
         std::string Dim1Name() const { return "Size"; }
         Measure Execute(IgushArrayTest& container) const { return ExecuteBody(container); }
         Measure Execute(VectorBaseline& container) const { return ExecuteBody(container); }
+        Measure Execute(TieredArray2& container) const { return ExecuteBody(container); }
+        Measure Execute(TieredArray3& container) const { return ExecuteBody(container); }
     private:
         template <class Cont>
         Measure ExecuteBody(Cont& container) const
@@ -176,6 +353,8 @@ private:
         std::string Dim2Name() const { return "Count"; }
         Measure Execute(IgushArrayTest& container) const { return ExecuteBody(container); }
         Measure Execute(VectorBaseline& container) const { return ExecuteBody(container); }
+        Measure Execute(IgushArrayTrivial& container) const { return ExecuteBody(container); }
+        Measure Execute(IgushArrayNotTrivial& container) const { return ExecuteBody(container); }
     private:
         template <class Cont>
         Measure ExecuteBody(Cont& container) const
@@ -229,7 +408,90 @@ private:
         }
     };
 
-    void perform_test(Test&);
+    class Construct : public Test1Dim {
+    public:
+        Construct(IgushArrayPerfTestPack* test_pack):Test1Dim(test_pack) {}
+        std::string TestName() const { return "Constructing from a range and copying"; }
+        std::string Dim1Name() const { return "Size"; }
+        Measure Execute(IgushArrayTest& container) const { return ExecuteBody(container); }
+        Measure Execute(VectorBaseline& container) const { return ExecuteBody(container); }
+        Measure Execute(IgushArrayTrivial& container) const { return ExecuteBody(container); }
+#ifdef _IGUSH_ARRAY_PMR
+        Measure Execute(IgushArrayPmr& container) const { return ExecuteBody(container); }
+#endif
+    private:
+        template <class Cont>
+        Measure ExecuteBody(Cont& container) const
+        {
+            unsigned count = _dim1;
+            std::vector<TestType> elem_vector;
+            _push_back_reserve<std::vector<TestType> >(elem_vector, count);
+
+            Measure measure;
+            for (unsigned test = 0; test < _test_iterations/100; ++test) {
+                _release(container);
+                measure.start();
+                Cont constructed(elem_vector.begin(), elem_vector.end(), container.get_allocator());
+                Cont copied(constructed, container.get_allocator());
+                measure.stop();
+            }
+            return measure;
+        }
+
+        //Every construction starts with an empty arena, as a request would
+        template <class Cont>
+        static void _release(Cont&) {}
+#ifdef _IGUSH_ARRAY_PMR
+        static void _release(IgushArrayPmr& container)
+        {
+            static_cast<std::pmr::monotonic_buffer_resource*>(
+                container.get_allocator().resource())->release();
+        }
+#endif
+    };
+
+    typedef void (*Variant)(IgushArrayTest&);
+    //Makes the array and measures the test on it
+    typedef std::function<Measure()> Contender;
+
+    template <class TestT>
+    void perform_test(TestT&);
+    template <class TestT>
+    void perform_test(TestT&, const std::string& variant_name, Variant variant);
+    void perform_test(Test&, const std::string& baseline_name, const Contender& baseline,
+        const std::string& variant_name, const Contender& variant);
+
+    template <class Cont, class TestT>
+    static Contender _contender(const TestT& test)
+        { return [&test]() { Cont container; return test.Execute(container); }; }
+    template <class TestT>
+    static Contender _kernels_contender(const TestT& test)
+        { return [&test]() { IgushArrayTrivial container; return test.ExecuteKernels(container); }; }
+#ifdef _IGUSH_ARRAY_PMR
+    template <class TestT>
+    static Contender _pmr_contender(const TestT& test)
+    {
+        return [&test]() {
+            std::pmr::monotonic_buffer_resource resource;
+            IgushArrayPmr container(&resource);
+            return test.Execute(container);
+        };
+    }
+#endif
+    void print_memory_overhead();
+
+    static void _arena_storage(IgushArrayTest& container)
+        { container.storage_mode(IgushArrayTest::ARENA); }
+    static void _huge_page_storage(IgushArrayTest& container)
+        { container.storage_mode(IgushArrayTest::HUGE_PAGES); }
+    static void _pow2_sizing(IgushArrayTest& container)
+        { container.sizing_mode(IgushArrayTest::POW2); }
+    static void _fixed_growth(IgushArrayTest& container)
+        { container.growth_mode(IgushArrayTest::FIXED); }
+    static void _slack_blocks(IgushArrayTest& container)
+        { container.block_mode(IgushArrayTest::SLACK); }
+    static void _fenwick_blocks(IgushArrayTest& container)
+        { container.block_mode(IgushArrayTest::FENWICK); }
 
     std::string GetTestPackName() const { return "IgushArray performance test pack"; }
 
@@ -243,6 +505,8 @@ private:
     unsigned _stop_count;
 
     static const unsigned _test_iterations;
+    //Keeps the compiler from dropping the measured loops
+    static volatile unsigned long _sink;
 };
 
 template <class Cont>
@@ -53,6 +53,13 @@ private:
         void Execute() const;
     };
 
+    class MoveOperations : public Test {
+    public:
+        MoveOperations(IgushArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Move constructor and assignment"; }
+        void Execute() const;
+    };
+
     class ResizeFunction : public Test {
     public:
         ResizeFunction(IgushArrayStabTestPack* test_pack):Test(test_pack) {}
@@ -144,10 +151,143 @@ private:
         void Execute() const;
     };
 
+    class IteratorArithmetic : public Test {
+    public:
+        IteratorArithmetic(IgushArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Iterator arithmetic over turned DEQs"; }
+        void Execute() const;
+    };
+
+    class ArenaStorage : public Test {
+    public:
+        ArenaStorage(IgushArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Arena storage mode"; }
+        void Execute() const;
+    };
+
+    class HugePageStorage : public Test {
+    public:
+        HugePageStorage(IgushArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Huge page storage mode"; }
+        void Execute() const;
+    };
+
+    class ThrowingCopy : public Test {
+    public:
+        ThrowingCopy(IgushArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Throwing copy in arena and huge page storage"; }
+        void Execute() const;
+    };
+
+    class Pow2Sizing : public Test {
+    public:
+        Pow2Sizing(IgushArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Power of two sizing mode"; }
+        void Execute() const;
+    };
+
+    class MoveOnlyElements : public Test {
+    public:
+        MoveOnlyElements(IgushArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Move only elements"; }
+        void Execute() const;
+    };
+
+    class GeometricGrowth : public Test {
+    public:
+        GeometricGrowth(IgushArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Geometric growth mode"; }
+        void Execute() const;
+    };
+
+    class SlackBlocks : public Test {
+    public:
+        SlackBlocks(IgushArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Slack block mode"; }
+        void Execute() const;
+    };
+
+    class ParallelCascade : public Test {
+    public:
+        ParallelCascade(IgushArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Parallel cascade"; }
+        void Execute() const;
+    };
+
+    class EraseIfUnique : public Test {
+    public:
+        EraseIfUnique(IgushArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Erase if and unique functions"; }
+        void Execute() const;
+    };
+
+    class ApplyEdits : public Test {
+    public:
+        ApplyEdits(IgushArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Apply edits function"; }
+        void Execute() const;
+    };
+
+    class CursorEdits : public Test {
+    public:
+        CursorEdits(IgushArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Cursor edits"; }
+        void Execute() const;
+    };
+
+    class SegmentVisitor : public Test {
+    public:
+        SegmentVisitor(IgushArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Segment visitor"; }
+        void Execute() const;
+    };
+
+    class SearchKernels : public Test {
+    public:
+        SearchKernels(IgushArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Search and reduction kernels"; }
+        void Execute() const;
+    };
+
+    class ParallelAlgorithms : public Test {
+    public:
+        ParallelAlgorithms(IgushArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Parallel algorithms"; }
+        void Execute() const;
+    };
+
+#ifdef _IGUSH_ARRAY_PMR
+    typedef ::pmr::IgushArray<TypeTest> IgushArrayPmr;
+
+    //Counts the bytes given out and not returned yet
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+        CountingResource():_live(0) {}
+        std::size_t live() const { return _live; }
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t alignment)
+            { _live += bytes; return std::pmr::new_delete_resource()->allocate(bytes, alignment); }
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment)
+            { _live -= bytes; std::pmr::new_delete_resource()->deallocate(p, bytes, alignment); }
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept
+            { return this == &other; }
+        std::size_t _live;
+    };
+
+    class PolymorphicAllocator : public Test {
+    public:
+        PolymorphicAllocator(IgushArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Polymorphic allocator"; }
+        void Execute() const;
+    };
+#endif
+
     std::string GetTestPackName() const { return "IgushArray stability test pack"; }
 
     template <class Cont>
     static inline void _push_back(Cont& container, unsigned push_count);
+    template <class IgushArrayT, class VectorT, class Value>
+    static void _check_kernels(const IgushArrayT& igush_array, const VectorT& vector, Value value);
     template <class Cont>
     static inline void _push_back_reserve(Cont& container, unsigned push_count);
 };
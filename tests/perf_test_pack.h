@@ -24,11 +24,11 @@ protected:
     public:
         Measure():_start(0),_sum(0) {}
         void start() { _start = clock(); }
-        void stop() { _sum += (clock() - _start)/(1.0*CLOCKS_PER_SEC)*1000; }
-        unsigned long time() const { return _sum; }
+        void stop() { _sum += clock() - _start; }
+        unsigned long time() const { return _sum/(1.0*CLOCKS_PER_SEC)*1000; }
     private:
         clock_t _start;
-        unsigned long _sum;
+        clock_t _sum;
     };
 
     template <class Field>
@@ -0,0 +1,80 @@
+/**
+    @author Eduard Igushev visit <www.igushev.com> e-mail <eduard@igushev.com>
+    @brief Stability test pack for sorted IgushArray
+
+    Warranty and license
+    The implementation is provided “as it is” with no warranty.
+    Any private and commercial usage is allowed.
+    Keeping the original name and link to the source is required.
+    Any feedback is welcomed :-)
+*/
+
+#ifndef _SORTED_IGUSH_ARRAY_STAB_H
+#define _SORTED_IGUSH_ARRAY_STAB_H
+
+#include "stab_test_pack.h"
+#include "sorted_igush_array.h"
+#include <vector>
+
+class SortedIgushArrayStabTestPack : public StabTestPack {
+public:
+    ~SortedIgushArrayStabTestPack() {}
+    SortedIgushArrayStabTestPack(unsigned count):StabTestPack(count) {}
+    void Pack();
+
+private:
+    typedef SortedIgushArray<TypeTest> SortedIgushArrayTest;
+    typedef std::vector<TypeBaseline> VectorBaseline;
+
+    class RangeConstructor : public Test {
+    public:
+        RangeConstructor(SortedIgushArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Range constructor"; }
+        void Execute() const;
+    };
+
+    class InsertFunction : public Test {
+    public:
+        InsertFunction(SortedIgushArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Insert function"; }
+        void Execute() const;
+    };
+
+    class InsertSortedFunction : public Test {
+    public:
+        InsertSortedFunction(SortedIgushArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Insert sorted batch function"; }
+        void Execute() const;
+    };
+
+    class EraseFunctions : public Test {
+    public:
+        EraseFunctions(SortedIgushArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Erase functions"; }
+        void Execute() const;
+    };
+
+    class SearchFunctions : public Test {
+    public:
+        SearchFunctions(SortedIgushArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Search functions"; }
+        void Execute() const;
+    };
+
+    class OrderStatistics : public Test {
+    public:
+        OrderStatistics(SortedIgushArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Order statistics"; }
+        void Execute() const;
+    };
+
+    std::string GetTestPackName() const { return "SortedIgushArray stability test pack"; }
+
+    //Inserts the values into both containers in a shuffled order
+    static void _insert(SortedIgushArrayTest& sorted_array_test, VectorBaseline& vector_baseline,
+        unsigned insert_count, unsigned range);
+    static void _check_search(const SortedIgushArrayTest& sorted_array_test, const VectorBaseline& vector_baseline,
+        TestType value);
+};
+
+#endif
@@ -13,6 +13,8 @@
 #define _TEST_PACK_H
 
 #include <string>
+#include <memory>
+#include <stdexcept>
 
 class TestPack {
 public:
@@ -58,6 +60,32 @@ protected:
         TestType _i;
     };
 
+    //Can be moved but not copied, a moved-from object has no value
+    class TypeMoveOnly {
+    public:
+        TypeMoveOnly(TestType i):_p(new TestType(i)) {}
+        operator TestType() const { return *_p; }
+    private:
+        std::unique_ptr<TestType> _p;
+    };
+
+    //Counts its instances, the copy throws once when the countdown set by throw_after() runs out
+    class TypeThrowing {
+    public:
+        TypeThrowing(TestType i):_i(i) { ++_count; }
+        TypeThrowing(const TypeThrowing& _obj):_i(_obj._i) { _copy(); ++_count; }
+        ~TypeThrowing() { --_count; }
+        TypeThrowing& operator =(const TypeThrowing& _obj) { _copy(); _i = _obj._i; return *this; }
+        operator TestType() const { return _i; }
+        static unsigned count() { return _count; }
+        static void throw_after(int copies) { _copies = copies; }
+    private:
+        static void _copy() { if (_copies >= 0 && !_copies--) throw std::runtime_error("Copy has thrown"); }
+        static unsigned _count;
+        static int _copies;
+        TestType _i;
+    };
+
     virtual std::string GetTestPackName() const = 0;
     void PrintHead();
     void PrintFoot();
@@ -0,0 +1,113 @@
+/**
+    @author Eduard Igushev visit <www.igushev.com> e-mail <eduard@igushev.com>
+    @brief Stability test pack for tiered array
+
+    Warranty and license
+    The implementation is provided “as it is” with no warranty.
+    Any private and commercial usage is allowed.
+    Keeping the original name and link to the source is required.
+    Any feedback is welcomed :-)
+*/
+
+#ifndef _TIERED_ARRAY_STAB_H
+#define _TIERED_ARRAY_STAB_H
+
+#include "stab_test_pack.h"
+#include "tiered_array.h"
+#include <vector>
+#if __cplusplus >= 201703L && __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+
+class TieredArrayStabTestPack : public StabTestPack {
+public:
+    ~TieredArrayStabTestPack() {}
+    TieredArrayStabTestPack(unsigned count):StabTestPack(count) {}
+    void Pack();
+
+private:
+    typedef std::vector<TypeBaseline> VectorBaseline;
+
+    class PushPopFunctions : public Test {
+    public:
+        PushPopFunctions(TieredArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Push/pop functions"; }
+        void Execute() const;
+    private:
+        template <unsigned Levels>
+        void ExecuteLevels() const;
+    };
+
+    class InsertOneFunction : public Test {
+    public:
+        InsertOneFunction(TieredArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Insert one element function"; }
+        void Execute() const;
+    private:
+        template <unsigned Levels>
+        void ExecuteLevels() const;
+    };
+
+    class EraseOneFunction : public Test {
+    public:
+        EraseOneFunction(TieredArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Erase one element function"; }
+        void Execute() const;
+    private:
+        template <unsigned Levels>
+        void ExecuteLevels() const;
+    };
+
+    class Growth : public Test {
+    public:
+        Growth(TieredArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Growth and copy"; }
+        void Execute() const;
+    private:
+        template <unsigned Levels>
+        void ExecuteLevels() const;
+    };
+
+    class MoveAndAllocators : public Test {
+    public:
+        MoveAndAllocators(TieredArrayStabTestPack* test_pack):Test(test_pack) {}
+        std::string TestName() const { return "Move and allocators"; }
+        void Execute() const;
+    private:
+        template <unsigned Levels>
+        void ExecuteLevels() const;
+    };
+
+#if __cplusplus >= 201703L && __has_include(<memory_resource>)
+    //Counts the bytes given out and not returned yet
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+        CountingResource():_live(0) {}
+        std::size_t live() const { return _live; }
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t alignment)
+            { _live += bytes; return std::pmr::new_delete_resource()->allocate(bytes, alignment); }
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment)
+            { _live -= bytes; std::pmr::new_delete_resource()->deallocate(p, bytes, alignment); }
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept
+            { return this == &other; }
+        std::size_t _live;
+    };
+#endif
+
+    std::string GetTestPackName() const { return "TieredArray stability test pack"; }
+
+    template <class Cont>
+    static inline void _push_back_reserve(Cont& container, unsigned push_count);
+};
+
+template <class Cont>
+/*static inline*/ void TieredArrayStabTestPack::_push_back_reserve(Cont& container, unsigned push_count)
+{
+    container.reserve(push_count);
+    TestType num = 0;
+    for (unsigned i = 0; i < push_count; ++i)
+        container.push_back(num++);
+}
+
+#endif